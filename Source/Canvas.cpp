@@ -393,6 +393,7 @@ Canvas::~Canvas()
     zoomScale.removeListener(this);
     editor->removeModifierKeyListener(this);
     pd->unregisterMessageListener(this);
+    pd->profiler.removeListener(this);
     patch.setVisible(false);
     selectedComponents.removeChangeListener(this);
 }
@@ -482,13 +483,21 @@ void Canvas::parentHierarchyChanged()
     }
 }
 
-bool Canvas::updateFramebuffers(NVGcontext* nvg, Rectangle<int> invalidRegion)
+int Canvas::updateObjectFramebuffers()
 {
-    for (auto& object : objects) {
-        if (object->gui) {
-            object->gui->updateFramebuffers();
+    int numUpdated = 0;
+    for (auto* object : framebufferObjects) {
+        if (object->framebuffersDirty.exchange(false)) {
+            object->updateFramebuffers();
+            numUpdated++;
         }
     }
+    return numUpdated;
+}
+
+int Canvas::updateFramebuffers(NVGcontext* nvg, Rectangle<int> invalidRegion)
+{
+    auto const numUpdated = updateObjectFramebuffers();
 
     auto pixelScale = getRenderScale();
     auto zoom = getValue<float>(zoomScale);
@@ -575,7 +584,7 @@ bool Canvas::updateFramebuffers(NVGcontext* nvg, Rectangle<int> invalidRegion)
         editor->nvgSurface.invalidateAll();
     }
 
-    return true;
+    return numUpdated;
 }
 
 // Callback from canvasViewport to perform actual rendering
@@ -809,20 +818,29 @@ float Canvas::getRenderScale() const
 
 void Canvas::renderAllObjects(NVGcontext* nvg, Rectangle<int> area)
 {
-    for (auto* obj : objects) {
-        auto b = obj->getBounds();
-        {
-            NVGScopedState scopedState(nvg);
-            nvgTranslate(nvg, b.getX(), b.getY());
-            if (b.intersects(area) && obj->isVisible()) {
-                obj->render(nvg);
-            }
-        }
+    SmallArray<Object*, 64> objectsToDraw;
+    objectIndex.forEachItemIn(area, [&objectsToDraw, area](Object* obj) {
+        if (obj->getBounds().intersects(area) && obj->isVisible())
+            objectsToDraw.add(obj);
+    });
+    std::sort(objectsToDraw.begin(), objectsToDraw.end(), [](Object* a, Object* b) { return a->zOrder < b->zOrder; });
 
-        // Draw label in canvas coordinates
-        obj->renderLabel(nvg);
+    for (auto* obj : objectsToDraw) {
+        NVGScopedState scopedState(nvg);
+        nvgTranslate(nvg, obj->getX(), obj->getY());
+        obj->render(nvg);
     }
+
+    // Draw labels in canvas coordinates
+    labelIndex.forEachItemIn(area, [this, nvg, area](ObjectLabel* label) {
+        if (label->getBounds().intersects(area)) {
+            NVGScopedState scopedState(nvg);
+            nvgTranslate(nvg, label->getX(), label->getY());
+            label->renderLabel(nvg, getRenderScale() * 2.0f);
+        }
+    });
 }
+
 void Canvas::renderAllConnections(NVGcontext* nvg, Rectangle<int> area)
 {
     if (!connectionLayer.isVisible())
@@ -835,7 +853,13 @@ void Canvas::renderAllConnections(NVGcontext* nvg, Rectangle<int> area)
     SmallArray<Connection*> connectionsToDrawSelected;
     Connection* hovered = nullptr;
 
-    for (auto* connection : connections) {
+    SmallArray<Connection*, 64> visibleConnections;
+    connectionIndex.forEachItemIn(area, [&visibleConnections](Connection* connection) {
+        visibleConnections.add(connection);
+    });
+    std::sort(visibleConnections.begin(), visibleConnections.end(), [](Connection* a, Connection* b) { return a->zOrder < b->zOrder; });
+
+    for (auto* connection : visibleConnections) {
         NVGScopedState scopedState(nvg);
         if (connection->intersectsRectangle(area) && connection->isVisible()) {
             if (connection->isMouseHovering())
@@ -896,6 +920,11 @@ bool Canvas::shouldShowObjectActivity()
     return showObjectActivity && !presentationMode.getValue() && !isGraph;
 }
 
+bool Canvas::shouldShowCPUUsage()
+{
+    return showCPUUsage && !isGraph;
+}
+
 bool Canvas::shouldShowIndex()
 {
     return showIndex && !presentationMode.getValue();
@@ -947,8 +976,15 @@ void Canvas::updateOverlays()
     showIndex = overlayState & Index;
     showConnectionDirection = overlayState & Direction;
     showConnectionActivity = overlayState & ConnectionActivity;
+    showCPUUsage = overlayState & CPUUsage;
 
     set_plugdata_activity_enabled(showObjectActivity);
+
+    if (shouldShowCPUUsage())
+        pd->profiler.addListener(this);
+    else
+        pd->profiler.removeListener(this);
+
     orderConnections();
 
     repaint();
@@ -1077,6 +1113,19 @@ void Canvas::saveAs(std::function<void()> const& nestedCallback)
         "*.pd", "Patch", this);
 }
 
+// Rendering and lasso selection follow the order of objects and connections in the patch
+void Canvas::updateZOrder()
+{
+    int order = 0;
+    for (auto* object : objects) {
+        object->zOrder = order++;
+    }
+    for (auto* connection : connections) {
+        connection->zOrder = order++;
+    }
+    nextZOrder = order;
+}
+
 void Canvas::handleAsyncUpdate()
 {
     performSynchronise();
@@ -1110,92 +1159,123 @@ void Canvas::synchroniseSplitCanvas()
 void Canvas::performSynchronise()
 {
     // Remove deleted connections
-    for (int n = connections.size() - 1; n >= 0; n--) {
-        if (!connections[n]->getPointer()) {
-            connections.remove_at(n);
-        }
-    }
+    connections.remove_if([](Connection* connection) {
+        return !connection->getPointer();
+    });
 
     // Remove deleted objects
-    for (int n = objects.size() - 1; n >= 0; n--) {
-        auto* object = objects[n];
-
+    objects.remove_if([this](Object* object) {
         // If the object is showing it's initial editor, meaning no object was assigned yet, allow it to exist without pointing to an object
         if (!object->getPointer() && !object->isInitialEditorShown()) {
             setSelected(object, false, false);
-            objects.remove_at(n);
+            return true;
         }
-    }
+        return false;
+    });
 
     // Check for connections that need to be remade because of invalid iolets
-    for (int n = connections.size() - 1; n >= 0; n--) {
-        if (!connections[n]->inlet || !connections[n]->outlet) {
-            connections.remove_at(n);
-        }
+    connections.remove_if([](Connection* connection) {
+        return !connection->inlet || !connection->outlet;
+    });
+
+    // Look up objects and connections by their pd pointer, so the whole sync is linear in the size of the patch
+    UnorderedMap<void*, Object*> objectsByPointer;
+    objectsByPointer.reserve(objects.size());
+    for (auto* object : objects) {
+        if (auto* ptr = object->getPointer())
+            objectsByPointer[ptr] = object;
+    }
+
+    // Read the whole patch with a single lock
+    // Weak references for new objects are registered under the same lock, so they can't be deleted before we create them
+    pd->lockAudioThread();
+    auto snapshot = patch.getSnapshot();
+    HeapArray<pd::WeakReference> newPdObjects;
+    for (auto& object : snapshot.objects) {
+        if (!objectsByPointer.contains(object.pointer))
+            newPdObjects.add(pd::WeakReference(object.pointer, pd));
     }
+    pd->unlockAudioThread();
 
-    auto pdObjects = patch.getObjects();
-    objects.reserve(pdObjects.size());
+    objects.reserve(snapshot.objects.size());
 
-    for (auto object : pdObjects) {
-        auto* it = std::find_if(objects.begin(), objects.end(), [&object](Object const* b) { return b->getPointer() && b->getPointer() == object.getRawUnchecked<void>(); });
-        if (!object.isValid())
-            continue;
+    UnorderedMap<void*, int> pdObjectIndices;
+    pdObjectIndices.reserve(snapshot.objects.size());
+
+    int newObjectIndex = 0;
+    for (auto& object : snapshot.objects) {
+        auto* ptr = object.pointer;
+        pdObjectIndices[ptr] = static_cast<int>(pdObjectIndices.size());
 
-        if (it == objects.end()) {
-            auto* newObject = objects.add(object, this);
+        auto it = objectsByPointer.find(ptr);
+        if (it == objectsByPointer.end()) {
+            auto& newPdObject = newPdObjects[newObjectIndex++];
+            if (!newPdObject.isValid())
+                continue;
+
+            auto* newObject = objects.add(newPdObject, this);
+            newObject->lastSynchronisedBounds = object.bounds;
             newObject->toFront(false);
 
             if (newObject->gui && newObject->gui->getLabel())
                 newObject->gui->getLabel()->toFront(false);
+
+            objectsByPointer[ptr] = newObject;
         } else {
-            auto* object = *it;
+            auto* existingObject = it->second;
 
-            // Check if number of inlets/outlets is correct
-            object->updateIolets();
-            object->updateBounds();
+            // Check if number of inlets/outlets is correct, using what we read from Pd in the snapshot
+            existingObject->updateIolets(object.numInlets, object.numOutlets, snapshot.getIoletSignals(object));
 
-            object->toFront(false);
-            if (object->gui && object->gui->getLabel())
-                object->gui->getLabel()->toFront(false);
-            if (object->gui)
-                object->gui->update();
+            // Only ask the gui for its bounds, which locks, if the object was moved or resized in Pd
+            if (existingObject->lastSynchronisedBounds != object.bounds) {
+                existingObject->lastSynchronisedBounds = object.bounds;
+                existingObject->updateBounds();
+            }
+
+            existingObject->toFront(false);
+            if (existingObject->gui && existingObject->gui->getLabel())
+                existingObject->gui->getLabel()->toFront(false);
+            if (existingObject->gui)
+                existingObject->gui->update();
         }
     }
 
     // Make sure objects have the same order
-    std::sort(objects.begin(), objects.end(),
-        [&pdObjects](Object* first, Object* second) mutable {
-            return pdObjects.index_of(first->getPointer()) < pdObjects.index_of(second->getPointer());
+    auto getPdIndex = [&pdObjectIndices](Object* object) {
+        auto it = pdObjectIndices.find(object->getPointer());
+        return it != pdObjectIndices.end() ? it->second : -1;
+    };
+    std::stable_sort(objects.begin(), objects.end(),
+        [&getPdIndex](Object* first, Object* second) {
+            return getPdIndex(first) < getPdIndex(second);
         });
 
-    auto pdConnections = patch.getConnections();
-    connections.reserve(pdConnections.size());
+    connections.reserve(snapshot.connections.size());
 
-    for (auto& connection : pdConnections) {
-        auto& [ptr, inno, inobj, outno, outobj] = connection;
+    UnorderedMap<void*, int> connectionIndices;
+    connectionIndices.reserve(connections.size());
+    for (int i = 0; i < connections.size(); i++) {
+        connectionIndices[connections[i]->getPointer()] = i;
+    }
+
+    for (auto& [ptr, outobj, outno, inobj, inno] : snapshot.connections) {
 
         Iolet *inlet = nullptr, *outlet = nullptr;
 
         // Find the objects that this connection is connected to
-        for (auto* obj : objects) {
-            if (outobj && &outobj->te_g == obj->getPointer()) {
-
-                // Check if we have enough outlets, should never return false
-                if (isPositiveAndBelow(obj->numInputs + outno, obj->iolets.size())) {
-                    outlet = obj->iolets[obj->numInputs + outno];
-                } else {
-                    break;
-                }
+        if (outobj) {
+            auto it = objectsByPointer.find(&outobj->te_g);
+            // Check if we have enough outlets, should never return false
+            if (it != objectsByPointer.end() && isPositiveAndBelow(it->second->numInputs + outno, it->second->iolets.size())) {
+                outlet = it->second->iolets[it->second->numInputs + outno];
             }
-            if (inobj && &inobj->te_g == obj->getPointer()) {
-
-                // Check if we have enough inlets, should never return false
-                if (isPositiveAndBelow(inno, obj->iolets.size())) {
-                    inlet = obj->iolets[inno];
-                } else {
-                    break;
-                }
+        }
+        if (inobj) {
+            auto it = objectsByPointer.find(&inobj->te_g);
+            // Check if we have enough inlets, should never return false
+            if (it != objectsByPointer.end() && isPositiveAndBelow(inno, it->second->iolets.size())) {
+                inlet = it->second->iolets[inno];
             }
         }
 
@@ -1205,21 +1285,18 @@ void Canvas::performSynchronise()
             continue;
         }
 
-        auto* it = std::find_if(connections.begin(), connections.end(),
-            [c_ptr = ptr](auto* c) {
-                return c_ptr == c->getPointer();
-            });
+        auto it = connectionIndices.find(ptr);
 
-        if (it == connections.end()) {
+        if (it == connectionIndices.end()) {
             connections.add(this, inlet, outlet, ptr);
         } else {
-            auto& c = *(*it);
+            auto idx = it->second;
+            auto& c = *connections[idx];
 
             // This is necessary to make resorting a subpatchers iolets work
             // And it can't hurt to check if the connection is valid anyway
             if (c.inlet != inlet || c.outlet != outlet) {
-                int idx = connections.index_of(*it);
-                connections.remove_one(*it);
+                connections.erase(idx);
                 connections.insert(idx, this, inlet, outlet, ptr);
             } else {
                 c.popPathState();
@@ -1227,6 +1304,13 @@ void Canvas::performSynchronise()
         }
     }
 
+    // Pd might have changed connections without us knowing, so the snapshot is the most reliable source for the index
+    outconnectIndex.clear();
+    outconnectIndex.reserve(snapshot.connections.size());
+    for (auto& connection : snapshot.connections) {
+        outconnectIndex[connection.pointer] = connection;
+    }
+
     if (!isGraph) {
         setTransform(AffineTransform().scaled(getValue<float>(zoomScale)));
     }
@@ -1234,6 +1318,8 @@ void Canvas::performSynchronise()
     if (graphArea)
         graphArea->updateBounds();
 
+    updateZOrder();
+
     editor->updateCommandStatus();
     repaint();
 
@@ -2673,33 +2759,51 @@ bool Canvas::isPointOutsidePluginArea(Point<int> point)
 void Canvas::findLassoItemsInArea(Array<WeakReference<Component>>& itemsFound, Rectangle<int> const& area)
 {
     auto const lassoBounds = area.withWidth(jmax(2, area.getWidth())).withHeight(jmax(2, area.getHeight()));
+    auto const anyModifiersDown = ModifierKeys::getCurrentModifiers().isAnyModifierKeyDown();
 
-    for (auto* object : objects) {
-        if (lassoBounds.intersects(object->getSelectableBounds())) {
-            itemsFound.add(object);
-        } else if (!ModifierKeys::getCurrentModifiers().isAnyModifierKeyDown()) {
-            setSelected(object, false, false);
+    SmallArray<Object*> foundObjects;
+    objectIndex.forEachItemIn(lassoBounds, [&foundObjects, lassoBounds](Object* object) {
+        if (lassoBounds.intersects(object->getSelectableBounds()))
+            foundObjects.add(object);
+    });
+    std::sort(foundObjects.begin(), foundObjects.end(), [](Object* a, Object* b) { return a->zOrder < b->zOrder; });
+
+    UnorderedSet<Component*> found;
+    for (auto* object : foundObjects) {
+        itemsFound.add(object);
+        found.insert(object);
+    }
+
+    // Only items that are currently selected can need deselecting, so we don't have to visit the whole patch
+    if (!anyModifiersDown) {
+        for (auto* object : getSelectionOfType<Object>()) {
+            if (!found.contains(object))
+                setSelected(object, false, false);
         }
     }
 
-    auto anyModifiersDown = ModifierKeys::getCurrentModifiers().isAnyModifierKeyDown();
     auto canSelectConnections = itemsFound.isEmpty() || anyModifiersDown;
 
-    for (auto& connection : connections) {
-        // If total bounds don't intersect, there can't be an intersection with the line
-        // This is cheaper than checking the path intersection, so do this first
-        if (!connection->getBounds().intersects(lassoBounds)) {
-            setSelected(connection, false, false);
-            continue;
-        }
+    if (canSelectConnections) {
+        SmallArray<Connection*> foundConnections;
+        connectionIndex.forEachItemIn(lassoBounds, [&foundConnections, lassoBounds](Connection* connection) {
+            // If total bounds don't intersect, there can't be an intersection with the line
+            // This is cheaper than checking the path intersection, so do this first
+            if (connection->getBounds().intersects(lassoBounds) && connection->intersects(lassoBounds.toFloat()))
+                foundConnections.add(connection);
+        });
+        std::sort(foundConnections.begin(), foundConnections.end(), [](Connection* a, Connection* b) { return a->zOrder < b->zOrder; });
 
-        // Check if path intersects with lasso
-        if (canSelectConnections && connection->intersects(lassoBounds.toFloat())) {
+        for (auto* connection : foundConnections) {
             itemsFound.add(connection);
-        } else if (!anyModifiersDown) {
-            setSelected(connection, false, false);
+            found.insert(connection);
         }
     }
+
+    for (auto* connection : getSelectionOfType<Connection>()) {
+        if (!found.contains(connection) && (!anyModifiersDown || !connection->getBounds().intersects(lassoBounds)))
+            setSelected(connection, false, false);
+    }
 }
 
 ObjectParameters& Canvas::getInspectorParameters()
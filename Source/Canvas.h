@@ -25,6 +25,7 @@ using namespace juce::gl;
 #include "Objects/ObjectParameters.h"
 #include "NVGSurface.h"
 #include "Utility/GlobalMouseListener.h"
+#include "Utility/SpatialIndex.h"
 
 namespace pd {
 class Patch;
@@ -34,6 +35,7 @@ class SuggestionComponent;
 class GraphArea;
 class Iolet;
 class Object;
+class ObjectBase;
 class Connection;
 class PluginEditor;
 class PluginProcessor;
@@ -43,6 +45,7 @@ class TabComponent;
 class BorderResizer;
 class CanvasSearchHighlight;
 class ObjectsResizer;
+class ObjectLabel;
 
 struct ObjectDragState {
     bool wasDragDuplicated : 1 = false;
@@ -91,7 +94,9 @@ public:
     void focusGained(FocusChangeType cause) override;
     void focusLost(FocusChangeType cause) override;
 
-    bool updateFramebuffers(NVGcontext* nvg, Rectangle<int> invalidRegion);
+    // Returns the number of objects that updated their framebuffers
+    int updateFramebuffers(NVGcontext* nvg, Rectangle<int> invalidRegion);
+    int updateObjectFramebuffers();
     void performRender(NVGcontext* nvg, Rectangle<int> invalidRegion);
 
     void resized() override;
@@ -103,6 +108,7 @@ public:
     void updateOverlays();
 
     bool shouldShowObjectActivity();
+    bool shouldShowCPUUsage();
     bool shouldShowIndex();
     bool shouldShowConnectionDirection();
     bool shouldShowConnectionActivity();
@@ -114,6 +120,7 @@ public:
     void synchroniseSplitCanvas();
     void synchronise();
     void performSynchronise();
+    void updateZOrder();
     void handleAsyncUpdate() override;
 
     void updateDrawables();
@@ -215,6 +222,22 @@ public:
 
     // Needs to be allocated before object and connection so they can deselect themselves in the destructor
     SelectedItemSet<WeakReference<Component>> selectedComponents;
+
+    // Spatial lookup for rendering and lasso selection, objects, labels and connections keep these up-to-date themselves
+    SpatialIndex<Object> objectIndex;
+    SpatialIndex<ObjectLabel> labelIndex;
+    SpatialIndex<Connection> connectionIndex;
+
+    // The objects and iolets of each pd connection, so we don't have to search the patch to change a connection
+    // Connections add and remove themselves, and synchronise rebuilds it from the patch
+    UnorderedMap<t_outconnect*, pd::PatchSnapshot::Connection> outconnectIndex;
+    int nextZOrder = 0;
+
+    // Objects that draw into framebuffers, they add and remove themselves
+    // We only visit these when they flagged that they have new content, instead of visiting every object on every frame
+    SmallArray<ObjectBase*> framebufferObjects;
+    ObjectBase* graphObject = nullptr; // The graph-on-parent object that draws this canvas, if any
+
     PooledPtrArray<Object> objects;
     PooledPtrArray<Connection> connections;
     PooledPtrArray<ConnectionBeingCreated> connectionsBeingCreated;
@@ -224,6 +247,7 @@ public:
     bool showConnectionOrder : 1 = false;
     bool connectionsBehind : 1 = true;
     bool showObjectActivity : 1 = false;
+    bool showCPUUsage : 1 = false;
     bool showIndex : 1 = false;
     bool showConnectionDirection : 1 = false;
     bool showConnectionActivity : 1 = false;
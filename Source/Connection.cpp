@@ -10,6 +10,7 @@ using namespace juce::gl;
 #include <nanovg.h>
 #include "Utility/Config.h"
 #include "Utility/Fonts.h"
+#include "Utility/ConnectionRouter.h"
 
 #include "NVGSurface.h"
 #include "Connection.h"
@@ -31,6 +32,7 @@ Connection::Connection(Canvas* parent, Iolet* s, Iolet* e, t_outconnect* oc)
     , cnv(parent)
     , ptr(parent->pd)
 {
+    zOrder = cnv->nextZOrder++;
     cnv->selectedComponents.addChangeListener(this);
 
     locked.referTo(parent->locked);
@@ -97,6 +99,8 @@ Connection::~Connection()
     
     cnv->pd->unregisterMessageListener(this);
     cnv->selectedComponents.removeChangeListener(this);
+    cnv->connectionIndex.remove(this);
+    cnv->outconnectIndex.erase(ptr.getRawUnchecked<t_outconnect>());
 
     if (outlet) {
         outlet->repaint();
@@ -377,6 +381,13 @@ void Connection::setPointer(t_outconnect* newPtr)
     if (originalPointer != newPtr) {
         ptr = pd::WeakReference(newPtr, cnv->pd);
 
+        cnv->outconnectIndex.erase(originalPointer);
+        if (newPtr) {
+            auto* checkedOut = pd::Interface::checkObject(outobj->getPointer());
+            auto* checkedIn = pd::Interface::checkObject(inobj->getPointer());
+            cnv->outconnectIndex[newPtr] = { newPtr, checkedOut, outIdx, checkedIn, inIdx };
+        }
+
         cnv->pd->unregisterMessageListener(this);
         cnv->pd->registerMessageListener(newPtr, this);
     }
@@ -749,6 +760,7 @@ void Connection::pathChanged()
     strokePath.clear();
     strokeType.createStrokedPath(strokePath, path, AffineTransform(), 1.0f);
     setBoundsToEnclose(getDrawableBounds());
+    cnv->connectionIndex.update(this, getBounds());
     repaint();
 }
 
@@ -1097,276 +1109,120 @@ void Connection::applyBestPath()
     repaint();
 }
 
-void Connection::findPath()
+void Connection::applyBestPaths(Canvas* cnv, SmallArray<Connection*> const& connections)
 {
-    if (!outlet || !inlet)
-        return;
-
-    auto pstart = getStartPoint();
-    auto pend = getEndPoint();
-
-    auto pathStack = PathPlan();
-    auto bestPath = PathPlan();
-
-    pathStack.reserve(8);
-
-    auto numFound = 0;
-
-    float incrementX, incrementY;
-
-    auto distance = pstart.getDistanceFrom(pend);
-    auto distanceX = std::abs(pstart.x - pend.x);
-    auto distanceY = std::abs(pstart.y - pend.y);
-
-    int maxXResolution = std::clamp<int>(distanceX / 10, 6, 14);
-    int maxYResolution = std::clamp<int>(distanceY / 10, 6, 14);
-
-    int resolutionX = 6;
-    int resolutionY = 6;
-
-    auto obstacles = SmallArray<Rectangle<float>>();
-    auto searchBounds = Rectangle<float>(pstart, pend);
+    Rectangle<float> routingArea;
+    for (auto* connection : connections) {
+        if (!connection->outlet || !connection->inlet)
+            continue;
 
-    for (auto* object : cnv->objects) {
-        if (object->getBounds().toFloat().intersects(searchBounds)) {
-            obstacles.add(object->getBounds().toFloat());
-        }
+        auto bounds = Rectangle<float>(connection->getStartPoint(), connection->getEndPoint());
+        routingArea = routingArea.isEmpty() ? bounds : routingArea.getUnion(bounds);
     }
 
-    // Look for paths at an increasing resolution
-    while (!numFound && resolutionX < maxXResolution && distance > 40) {
-
-        // Find paths on a resolution*resolution lattice ObjectGrid
-        incrementX = std::max<float>(1, distanceX / resolutionX);
-        incrementY = std::max<float>(1, distanceY / resolutionY);
-
-        numFound = findLatticePaths(bestPath, pathStack, pend, pstart, { incrementX, incrementY });
-
-        if (resolutionX < maxXResolution)
-            resolutionX++;
-        if (resolutionY < maxXResolution)
-            resolutionY++;
+    auto router = createRouter(cnv, routingArea);
+    for (auto* connection : connections) {
+        connection->segmented = true;
+        connection->findPath(*router);
+        connection->updatePath();
+        connection->repaint();
+    }
+}
 
-        if (resolutionX > maxXResolution || resolutionY > maxYResolution)
-            break;
+std::unique_ptr<ConnectionRouter> Connection::createRouter(Canvas* cnv, Rectangle<float> area)
+{
+    // Leave room around the connections to route around the objects in the way
+    auto routingArea = area.toNearestIntEdges().expanded(routingMargin);
+    auto router = std::make_unique<ConnectionRouter>(routingArea);
 
-        pathStack.clear();
-    }
+    cnv->objectIndex.forEachItemIn(routingArea, [&router](Object* object) {
+        router->addObstacle(object->getBounds().reduced(Object::margin));
+    });
 
-    PathPlan simplifiedPath;
+    return router;
+}
 
-    bool direction;
-    if (!bestPath.empty()) {
-        simplifiedPath.add(bestPath.front());
+void Connection::findPath()
+{
+    if (!outlet || !inlet)
+        return;
 
-        direction = approximatelyEqual(bestPath[0].x, bestPath[1].x);
+    auto router = createRouter(cnv, Rectangle<float>(getStartPoint(), getEndPoint()));
+    findPath(*router);
+}
 
-        if (!direction)
-            simplifiedPath.add(bestPath.front());
+void Connection::findPath(ConnectionRouter& router)
+{
+    if (!outlet || !inlet)
+        return;
 
-        for (int n = 1; n < bestPath.size(); n++) {
-            if ((bestPath[n].x != bestPath[n - 1].x && direction) || (bestPath[n].y != bestPath[n - 1].y && !direction)) {
-                simplifiedPath.add(bestPath[n - 1]);
-                direction = !direction;
-            }
-        }
+    auto pstart = getStartPoint();
+    auto pend = getEndPoint();
 
-        simplifiedPath.add(bestPath.back());
+    auto plan = pstart.getDistanceFrom(pend) > 40 ? router.route(pstart, pend) : PathPlan();
 
-        if (!direction)
-            simplifiedPath.add(bestPath.back());
-    } else {
+    // If there is no route, or the iolets are too close for one, fall back to a simple staircase
+    if (plan.empty()) {
         if (pend.y < pstart.y) {
             int xHalfDistance = (pstart.x - pend.x) / 2;
 
-            simplifiedPath.add(pend); // double to make it draggable
-            simplifiedPath.add(pend);
-            simplifiedPath.emplace_back(pend.x + xHalfDistance, pend.y);
-            simplifiedPath.emplace_back(pend.x + xHalfDistance, pstart.y);
-            simplifiedPath.add(pstart);
-            simplifiedPath.add(pstart);
+            plan.add(pend); // double to make it draggable
+            plan.add(pend);
+            plan.emplace_back(pend.x + xHalfDistance, pend.y);
+            plan.emplace_back(pend.x + xHalfDistance, pstart.y);
+            plan.add(pstart);
+            plan.add(pstart);
         } else {
             int yHalfDistance = (pstart.y - pend.y) / 2;
-            simplifiedPath.add(pend);
-            simplifiedPath.emplace_back(pend.x, pend.y + yHalfDistance);
-            simplifiedPath.emplace_back(pstart.x, pend.y + yHalfDistance);
-            simplifiedPath.add(pstart);
+            plan.add(pend);
+            plan.emplace_back(pend.x, pend.y + yHalfDistance);
+            plan.emplace_back(pstart.x, pend.y + yHalfDistance);
+            plan.add(pstart);
         }
+        std::reverse(plan.begin(), plan.end());
     }
-    std::reverse(simplifiedPath.begin(), simplifiedPath.end());
 
-    currentPlan = simplifiedPath;
+    currentPlan = plan;
 
     pushPathState();
 }
 
-int Connection::findLatticePaths(PathPlan& bestPath, PathPlan& pathStack, Point<float> pstart, Point<float> pend, Point<float> increment)
-{
-    auto obstacles = SmallArray<Object*>();
-    auto searchBounds = Rectangle<float>(pstart, pend);
-
-    for (auto* object : cnv->objects) {
-        if (object->getBounds().toFloat().intersects(searchBounds)) {
-            obstacles.add(object);
-        }
-    }
-
-    // Stop after we've found a path
-    if (!bestPath.empty())
-        return 0;
-
-    // Add point to path
-    pathStack.add(pstart);
-
-    // Check if it intersects any object
-    if (pathStack.size() > 1 && straightLineIntersectsObject(Line<float>(pathStack.back(), *(pathStack.end() - 2)), obstacles)) {
-        return 0;
-    }
-
-    bool endVertically = pathStack[0].y > pend.y;
-
-    // Check if we've reached the destination
-    if (std::abs(pstart.x - pend.x) < (increment.x * 0.5) && std::abs(pstart.y - pend.y) < (increment.y * 0.5)) {
-        bestPath = pathStack;
-        return 1;
-    }
-
-    // Count the number of found paths
-    int count = 0;
-
-    // Get current stack to revert to after each trial
-    auto pathCopy = pathStack;
-
-    auto followLine = [this, &count, &pathCopy, &bestPath, &pathStack, &increment](Point<float> currentOutlet, Point<float> currentInlet, bool isX) {
-        auto& coord1 = isX ? currentOutlet.x : currentOutlet.y;
-        auto& coord2 = isX ? currentInlet.x : currentInlet.y;
-        auto& incr = isX ? increment.x : increment.y;
-
-        if (std::abs(coord1 - coord2) >= incr) {
-            coord1 > coord2 ? coord1 -= incr : coord1 += incr;
-            count += findLatticePaths(bestPath, pathStack, currentOutlet, currentInlet, increment);
-            pathStack = pathCopy;
-        }
-    };
-
-    // If we're halfway on the axis, change preferred direction by inverting search order
-    // This will make it do a staircase effect
-    if (endVertically) {
-        if (std::abs(pstart.y - pend.y) >= std::abs(pathStack[0].y - pend.y) * 0.5) {
-            followLine(pstart, pend, false);
-            followLine(pstart, pend, true);
-        } else {
-            followLine(pstart, pend, true);
-            followLine(pstart, pend, false);
-        }
-    } else {
-        if (std::abs(pstart.x - pend.x) >= std::abs(pathStack[0].x - pend.x) * 0.5) {
-            followLine(pstart, pend, true);
-            followLine(pstart, pend, false);
-        } else {
-            followLine(pstart, pend, false);
-            followLine(pstart, pend, true);
-        }
-    }
-
-    return count;
-}
-
-bool Connection::straightLineIntersectsObject(Line<float> toCheck, SmallArray<Object*>& objects)
-{
-
-    for (auto const& object : objects) {
-        auto bounds = object->getBounds().expanded(1);
-
-        if (object == outobj || object == inobj || !bounds.intersects(getBounds()))
-            continue;
-
-        auto intersectV = [](Line<float> first, Line<float> second) {
-            if (first.getStartY() > first.getEndY()) {
-                first = { first.getEnd(), first.getStart() };
-            }
-
-            return first.getStartX() > second.getStartX() && first.getStartX() < second.getEndX() && second.getStartY() > first.getStartY() && second.getStartY() < first.getEndY();
-        };
-
-        auto intersectH = [](Line<float> first, Line<float> second) {
-            if (first.getStartX() > first.getEndX()) {
-                first = { first.getEnd(), first.getStart() };
-            }
-
-            return first.getStartY() > second.getStartY() && first.getStartY() < second.getEndY() && second.getStartX() > first.getStartX() && second.getStartX() < first.getEndX();
-        };
-
-        bool intersectsV = toCheck.isVertical() && (intersectV(toCheck, Line<float>(bounds.getTopLeft().toFloat(), bounds.getTopRight().toFloat())) || intersectV(toCheck, Line<float>(bounds.getBottomRight().toFloat(), bounds.getBottomLeft().toFloat())));
-
-        bool intersectsH = toCheck.isHorizontal() && (intersectH(toCheck, Line<float>(bounds.getTopRight().toFloat(), bounds.getBottomRight().toFloat())) || intersectH(toCheck, Line<float>(bounds.getTopLeft().toFloat(), bounds.getBottomLeft().toFloat())));
-        if (intersectsV || intersectsH) {
-            return true;
-        }
-
-        /*
-         if(bounds.toFloat().intersects(toCheck.toFloat())) {
-         return true;
-         } TODO: benchmark these two options */
-        // TODO: possible mark areas that have already been visited?
-    }
-    return false;
-}
-
 void ConnectionPathUpdater::timerCallback()
 {
     stopTimer();
 
-    std::pair<Component::SafePointer<Connection>, t_symbol*> currentConnection;
-
-    canvas->patch.startUndoSequence("SetConnectionPaths");
+    SmallArray<std::pair<Component::SafePointer<Connection>, t_symbol*>> updates;
+    std::pair<Component::SafePointer<Connection>, t_symbol*> update;
+    while (connectionUpdateQueue.try_dequeue(update)) {
+        if (update.first)
+            updates.add(update);
+    }
 
-    while (connectionUpdateQueue.try_dequeue(currentConnection)) {
+    if (updates.empty())
+        return;
 
-        auto& [connection, newPathState] = currentConnection;
+    // Apply the whole batch while holding the lock once, and as a single undo step
+    canvas->pd->lockAudioThread();
+    canvas->patch.startUndoSequence("SetConnectionPaths");
 
+    for (auto& [connection, newPathState] : updates) {
         if (!connection)
             continue;
 
-        bool found = false;
-        t_linetraverser t;
-
-        t_object* outObj;
-        int outIdx;
-        t_object* inObj;
-        int inIdx;
-
-        if (auto patch = connection->cnv->patch.getPointer()) {
-
-            // Get connections from pd
-            linetraverser_start(&t, patch.get());
-
-            while (auto* oc = linetraverser_next_nosize(&t)) {
-
-                if (oc == connection->ptr.getRaw<t_outconnect>()) {
-
-                    outObj = t.tr_ob;
-                    outIdx = t.tr_outno;
-                    inObj = t.tr_ob2;
-                    inIdx = t.tr_inno;
-
-                    found = true;
-                    break;
-                }
-            }
-
-            if (!found)
-                continue;
+        auto* oc = connection->ptr.getRaw<t_outconnect>();
+        auto it = canvas->outconnectIndex.find(oc);
+        if (!oc || it == canvas->outconnectIndex.end())
+            continue;
 
-            if (auto oc = connection->ptr.get<t_outconnect>()) {
-                t_symbol* oldPathState = outconnect_get_path_data(oc.get());
-                auto* newConnection = connection->cnv->patch.setConnctionPath(outObj, outIdx, inObj, inIdx, oldPathState, newPathState);
-                connection->setPointer(newConnection);
-            }
-        }
+        // Copy, because setting the path replaces the connection in the index
+        auto const target = it->second;
+        t_symbol* oldPathState = outconnect_get_path_data(oc);
+        auto* newConnection = canvas->patch.setConnctionPath(target.outObject, target.outlet, target.inObject, target.inlet, oldPathState, newPathState);
+        connection->setPointer(newConnection);
     }
 
     canvas->patch.endUndoSequence("SetConnectionPaths");
+    canvas->pd->unlockAudioThread();
 }
 
 void Connection::receiveMessage(t_symbol* symbol, SmallArray<pd::Atom> const& atoms)
@@ -22,6 +22,7 @@
 using PathPlan = SmallArray<Point<float>>;
 
 class Canvas;
+class ConnectionRouter;
 class Connection : public DrawablePath
     , public ComponentListener
     , public ChangeListener
@@ -33,6 +34,9 @@ public:
     int outIdx;
     int numSignalChannels = 1;
 
+    // Position in the canvas' render order
+    int zOrder = 0;
+
     WeakReference<Iolet> inlet, outlet;
     WeakReference<Object> inobj, outobj;
 
@@ -89,13 +93,13 @@ public:
     void componentMovedOrResized(Component& component, bool wasMoved, bool wasResized) override;
 
     // Pathfinding
-    int findLatticePaths(PathPlan& bestPath, PathPlan& pathStack, Point<float> start, Point<float> end, Point<float> increment);
-
     void findPath();
+    void findPath(ConnectionRouter& router);
 
     void applyBestPath();
 
-    bool straightLineIntersectsObject(Line<float> toCheck, SmallArray<Object*>& objects);
+    // Routes all connections on the same obstacle grid
+    static void applyBestPaths(Canvas* cnv, SmallArray<Connection*> const& connections);
 
     void receiveMessage(t_symbol* symbol, SmallArray<pd::Atom> const& atoms) override;
 
@@ -114,6 +118,10 @@ private:
 
     static t_pd* getTargetObject(t_outconnect* oc);
 
+    // Builds an obstacle grid of the objects around the area
+    static std::unique_ptr<ConnectionRouter> createRouter(Canvas* cnv, Rectangle<float> area);
+    static inline constexpr int routingMargin = 150;
+
     void animate();
 
     int getMultiConnectNumber();
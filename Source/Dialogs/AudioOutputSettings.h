@@ -62,6 +62,61 @@ private:
     TextButton eight = TextButton("8x");
 };
 
+class OversampleQualitySettings : public Component {
+public:
+    std::function<void(int)> onChange = [](int) { };
+
+    explicit OversampleQualitySettings(int currentSelection)
+    {
+        draft.setConnectedEdges(Button::ConnectedOnRight);
+        minimumPhase.setConnectedEdges(Button::ConnectedOnLeft | Button::ConnectedOnRight);
+        linearPhase.setConnectedEdges(Button::ConnectedOnLeft);
+
+        draft.setTooltip("Cheap filters with more aliasing, for sketching on a busy CPU");
+        minimumPhase.setTooltip("Minimum phase IIR filters with little latency");
+        linearPhase.setTooltip("Linear phase FIR filters: most transparent, but with more latency");
+
+        auto buttons = SmallArray<TextButton*> { &draft, &minimumPhase, &linearPhase };
+
+        int i = 0;
+        for (auto* button : buttons) {
+            button->setRadioGroupId(hash("oversampling_quality_selector"));
+            button->setClickingTogglesState(true);
+            button->onClick = [this, i]() {
+                onChange(i);
+            };
+
+            button->setColour(TextButton::textColourOffId, findColour(PlugDataColour::popupMenuTextColourId));
+            button->setColour(TextButton::textColourOnId, findColour(PlugDataColour::popupMenuTextColourId));
+            button->setColour(TextButton::buttonColourId, findColour(PlugDataColour::popupMenuBackgroundColourId).contrasting(0.04f));
+            button->setColour(TextButton::buttonOnColourId, findColour(PlugDataColour::popupMenuBackgroundColourId).contrasting(0.075f));
+            button->setColour(ComboBox::outlineColourId, Colours::transparentBlack);
+
+            addAndMakeVisible(button);
+            i++;
+        }
+
+        buttons[currentSelection]->setToggleState(true, dontSendNotification);
+
+        setSize(180, 50);
+    }
+
+private:
+    void resized() override
+    {
+        auto b = getLocalBounds().reduced(4, 4);
+        auto buttonWidth = b.getWidth() / 3;
+
+        draft.setBounds(b.removeFromLeft(buttonWidth));
+        minimumPhase.setBounds(b.removeFromLeft(buttonWidth).expanded(1, 0));
+        linearPhase.setBounds(b.removeFromLeft(buttonWidth).expanded(1, 0));
+    }
+
+    TextButton draft = TextButton("Draft");
+    TextButton minimumPhase = TextButton("IIR");
+    TextButton linearPhase = TextButton("FIR");
+};
+
 class LimiterSettings : public Component {
 public:
     std::function<void(int)> onChange = [](int) { };
@@ -121,7 +176,8 @@ class AudioOutputSettings : public Component {
 public:
     AudioOutputSettings(PluginProcessor* pd)
         : limiterSettings(SettingsFile::getInstance()->getProperty<int>("limiter_threshold"))
-        , oversampleSettings(SettingsFile::getInstance()->getProperty<int>("oversampling"))
+        , oversampleSettings(pd->oversampling)
+        , oversampleQualitySettings(pd->oversamplingQuality)
     {
         addAndMakeVisible(limiterSettings);
         limiterSettings.onChange = [pd](int value) {
@@ -133,7 +189,12 @@ public:
             pd->setOversampling(value);
         };
 
-        setSize(170, 125);
+        addAndMakeVisible(oversampleQualitySettings);
+        oversampleQualitySettings.onChange = [pd](int value) {
+            pd->setOversamplingQuality(value);
+        };
+
+        setSize(170, 185);
     }
 
     ~AudioOutputSettings()
@@ -149,6 +210,9 @@ public:
 
         bounds.removeFromTop(32);
         oversampleSettings.setBounds(bounds.removeFromTop(28));
+
+        bounds.removeFromTop(32);
+        oversampleQualitySettings.setBounds(bounds.removeFromTop(28));
     }
 
     void paint(Graphics& g) override
@@ -166,6 +230,13 @@ public:
 
         g.setColour(findColour(PlugDataColour::toolbarOutlineColourId));
         g.drawLine(4, 84, getWidth() - 8, 84);
+
+        g.setColour(findColour(PlugDataColour::popupMenuTextColourId));
+        g.setFont(Fonts::getBoldFont().withHeight(15));
+        g.drawText("Oversampling Quality", 0, 116, getWidth(), 24, Justification::centred);
+
+        g.setColour(findColour(PlugDataColour::toolbarOutlineColourId));
+        g.drawLine(4, 144, getWidth() - 8, 144);
     }
 
     static void show(PluginEditor* editor, Rectangle<int> bounds)
@@ -184,4 +255,5 @@ private:
 
     LimiterSettings limiterSettings;
     OversampleSettings oversampleSettings;
+    OversampleQualitySettings oversampleQualitySettings;
 };
@@ -134,6 +134,7 @@ public:
 
         object.add(new OverlaySelector(overlayTree, ActivationState, "activation_state", "Activity", "Object activity"));
         object.add(new OverlaySelector(overlayTree, Index, "index", "Index", "Object index in patch"));
+        object.add(new OverlaySelector(overlayTree, CPUUsage, "cpu_usage", "CPU", "DSP load per object"));
 
         connection.add(new OverlaySelector(overlayTree, ConnectionActivity, "connection_activity", "Activity", "Connection activity"));
         connection.add(new OverlaySelector(overlayTree, Direction, "direction", "Direction", "Direction of connections"));
@@ -29,21 +29,22 @@ public:
         prevTime = startTime;
     }
 
-    void render(NVGcontext* nvg, int width, int height, float scale)
+    // Shows the frame rate, and how many objects updated their framebuffers in the last frame
+    void render(NVGcontext* nvg, int width, int height, float scale, int numFramebufferUpdates)
     {
         nvgBeginFrame(nvg, width, height, scale);
 
         nvgFillColor(nvg, nvgRGBA(40, 40, 40, 255));
-        nvgFillRect(nvg, 0, 0, 40, 22);
+        nvgFillRect(nvg, 0, 0, 110, 22);
 
         nvgFontSize(nvg, 20.0f);
         nvgTextAlign(nvg, NVG_ALIGN_LEFT | NVG_ALIGN_TOP);
         nvgFillColor(nvg, nvgRGBA(240, 240, 240, 255));
-        StackArray<char, 16> fpsBuf;
-        snprintf(fpsBuf.data(), 16, "%d", static_cast<int>(round(1.0f / getAverageFrameTime())));
+        StackArray<char, 32> fpsBuf;
+        snprintf(fpsBuf.data(), 32, "%d | %d", static_cast<int>(round(1.0f / getAverageFrameTime())), numFramebufferUpdates);
         nvgText(nvg, 7, 2, fpsBuf.data(), nullptr);
 
-        nvgGlobalScissor(nvg, 0, 0, 40 * scale, 22 * scale);
+        nvgGlobalScissor(nvg, 0, 0, 110 * scale, 22 * scale);
         nvgEndFrame(nvg);
     }
     void addFrameTime()
@@ -171,6 +172,7 @@ void NVGSurface::detachContext()
     if (makeContextActive()) {
         NVGFramebuffer::clearAll(nvg);
         NVGImage::clearAll(nvg);
+        NVGTextureAtlas::clearAll(nvg);
         NVGCachedPath::clearAll(nvg);
 
         if (invalidFBO) {
@@ -206,7 +208,7 @@ void NVGSurface::updateBufferSize()
         invalidFBO = nvgCreateFramebuffer(nvg, scaledWidth, scaledHeight, NVG_IMAGE_PREMULTIPLIED);
         fbWidth = scaledWidth;
         fbHeight = scaledHeight;
-        invalidArea = getLocalBounds();
+        invalidateAll();
     }
 }
 
@@ -224,6 +226,7 @@ void NVGSurface::lookAndFeelChanged()
     if (makeContextActive()) {
         NVGFramebuffer::clearAll(nvg);
         NVGImage::clearAll(nvg);
+        NVGTextureAtlas::clearAll(nvg);
         invalidateAll();
     }
 }
@@ -293,14 +296,64 @@ void NVGSurface::resized()
     backupImageComponent.setBounds(editor->getLocalArea(this, getLocalBounds()));
 }
 
+static int64 getArea(Rectangle<int> r)
+{
+    return static_cast<int64>(r.getWidth()) * r.getHeight();
+}
+
 void NVGSurface::invalidateAll()
 {
-    invalidArea = invalidArea.getUnion(getLocalBounds());
+    damagedAreas.clear();
+    damagedAreas.add(getLocalBounds());
 }
 
 void NVGSurface::invalidateArea(Rectangle<int> area)
 {
-    invalidArea = invalidArea.getUnion(area);
+    area = area.getIntersection(getLocalBounds());
+    if (area.isEmpty())
+        return;
+
+    // We keep areas that are far apart separate, so two blinking objects in opposite corners don't repaint everything in between
+    for (int i = 0; i < damagedAreas.size();) {
+        if (shouldMergeAreas(damagedAreas[i], area)) {
+            area = area.getUnion(damagedAreas[i]);
+            damagedAreas.erase(damagedAreas.begin() + i);
+            i = 0; // The merged area might now touch areas that we already checked
+        } else {
+            i++;
+        }
+    }
+    damagedAreas.add(area);
+
+    // Every area is a separate render pass, so after a certain amount it's cheaper to draw a bit more
+    while (damagedAreas.size() > maxDamagedAreas)
+        mergeClosestAreas();
+}
+
+bool NVGSurface::shouldMergeAreas(Rectangle<int> first, Rectangle<int> second)
+{
+    // Merge when drawing the union costs about the same as drawing both, which also catches areas that contain each other
+    constexpr int64 maxWastedArea = 64 * 64;
+    return getArea(first.getUnion(second)) <= getArea(first) + getArea(second) + maxWastedArea;
+}
+
+void NVGSurface::mergeClosestAreas()
+{
+    int bestFirst = 0, bestSecond = 1;
+    auto leastWasted = std::numeric_limits<int64>::max();
+    for (int i = 0; i < damagedAreas.size(); i++) {
+        for (int j = i + 1; j < damagedAreas.size(); j++) {
+            auto const wasted = getArea(damagedAreas[i].getUnion(damagedAreas[j])) - getArea(damagedAreas[i]) - getArea(damagedAreas[j]);
+            if (wasted < leastWasted) {
+                leastWasted = wasted;
+                bestFirst = i;
+                bestSecond = j;
+            }
+        }
+    }
+
+    damagedAreas[bestFirst] = damagedAreas[bestFirst].getUnion(damagedAreas[bestSecond]);
+    damagedAreas.erase(damagedAreas.begin() + bestSecond);
 }
 
 void NVGSurface::render()
@@ -355,35 +408,53 @@ void NVGSurface::render()
 
     updateBufferSize();
 
-    invalidArea = invalidArea.getIntersection(getLocalBounds());
+#if ENABLE_FPS_COUNT
+    invalidateArea({ 0, 0, 110, 22 }); // Keep the counters up-to-date
+#endif
 
+    int numFramebufferUpdates = 0;
     if (auto* cnv = editor->getPluginModeCanvas()) {
-        cnv->updateFramebuffers(nvg, cnv->getLocalBounds());
+        numFramebufferUpdates += cnv->updateFramebuffers(nvg, cnv->getLocalBounds());
     } else {
         for (auto* cnv : editor->getTabComponent().getVisibleCanvases()) {
-            cnv->updateFramebuffers(nvg, cnv->getLocalBounds());
+            numFramebufferUpdates += cnv->updateFramebuffers(nvg, cnv->getLocalBounds());
         }
     }
 
-    if (!invalidArea.isEmpty()) {
-        // Draw only the invalidated region on top of framebuffer
+    if (damagedAreas.not_empty()) {
+        // Draw only the invalidated regions on top of framebuffer, which still holds the previous frame
         nvgBindFramebuffer(invalidFBO);
         nvgViewport(0, 0, viewWidth, viewHeight);
+
+        // Take the list before rendering, areas that get invalidated while rendering are kept for the next frame
+        decltype(damagedAreas) areas;
+        std::swap(areas, damagedAreas);
+
+        Rectangle<int> renderedArea;
+        for (auto area : areas) {
+            invalidArea = area.getIntersection(getLocalBounds());
+            if (invalidArea.isEmpty())
+                continue;
+
 #if NANOVG_GL_IMPLEMENTATION
-        glClear(GL_STENCIL_BUFFER_BIT);
+            glClear(GL_STENCIL_BUFFER_BIT);
 #endif
-        nvgBeginFrame(nvg, getWidth() * desktopScale, getHeight() * desktopScale, devicePixelScale);
-        nvgScale(nvg, desktopScale, desktopScale);
-        editor->renderArea(nvg, invalidArea);
-        nvgGlobalScissor(nvg, invalidArea.getX() * pixelScale, invalidArea.getY() * pixelScale, invalidArea.getWidth() * pixelScale, invalidArea.getHeight() * pixelScale);
-        nvgEndFrame(nvg);
+            nvgBeginFrame(nvg, getWidth() * desktopScale, getHeight() * desktopScale, devicePixelScale);
+            nvgScale(nvg, desktopScale, desktopScale);
+            editor->renderArea(nvg, invalidArea);
+            nvgGlobalScissor(nvg, invalidArea.getX() * pixelScale, invalidArea.getY() * pixelScale, invalidArea.getWidth() * pixelScale, invalidArea.getHeight() * pixelScale);
+            NVGTextureAtlas::flush(nvg);
+            nvgEndFrame(nvg);
+
+            renderedArea = renderedArea.getUnion(invalidArea);
+        }
 
 #if ENABLE_FPS_COUNT
-        frameTimer->render(nvg, getWidth(), getHeight(), pixelScale);
+        frameTimer->render(nvg, getWidth(), getHeight(), pixelScale, numFramebufferUpdates);
 #endif
 
         if (renderThroughImage) {
-            renderFrameToImage(backupRenderImage, invalidArea);
+            renderFrameToImage(backupRenderImage, renderedArea);
         } else {
             needsBufferSwap = true;
         }
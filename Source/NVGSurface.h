@@ -52,6 +52,7 @@ public:
 
     void lookAndFeelChanged() override;
 
+    // The area that is being rendered right now
     Rectangle<int> getInvalidArea() { return invalidArea; }
 
     float getRenderScale() const;
@@ -113,11 +114,17 @@ private:
     // Sets the surface context to render through floating window, or inside editor as image
     void updateWindowContextVisibility();
 
+    static bool shouldMergeAreas(Rectangle<int> first, Rectangle<int> second);
+    void mergeClosestAreas();
+
     PluginEditor* editor;
     NVGcontext* nvg = nullptr;
     bool needsBufferSwap = false;
     std::unique_ptr<VBlankAttachment> vBlankAttachment;
 
+    // Separate areas that need to be redrawn, invalidFBO keeps the rest of the last frame
+    static constexpr int maxDamagedAreas = 8;
+    SmallArray<Rectangle<int>, maxDamagedAreas> damagedAreas;
     Rectangle<int> invalidArea;
     NVGframebuffer* invalidFBO = nullptr;
     int fbWidth = 0, fbHeight = 0;
@@ -458,6 +465,371 @@ public:
 };
 
 
+// Packs small images into a few shared textures, so a patch full of text doesn't need a texture for every object
+// Pages are drawn into on the CPU and uploaded once per frame, no matter how many images changed on them
+class NVGTextureAtlas {
+public:
+    static constexpr int pageSize = 1024;
+    static constexpr int maxImageSize = pageSize / 2; // Bigger images should use their own NVGImage
+    static constexpr int maxPages = 32;
+
+    struct Location {
+        int page = -1;
+        uint32 generation = 0;
+        Rectangle<int> slot;   // Space reserved in the page, including the padding
+        Rectangle<int> bounds; // Area of the slot that holds the image
+    };
+
+    static NVGTextureAtlas* getForContext(NVGcontext* nvg)
+    {
+        auto& atlas = atlases[nvg];
+        if (!atlas)
+            atlas = std::make_unique<NVGTextureAtlas>(nvg);
+        return atlas.get();
+    }
+
+    static NVGTextureAtlas* findForContext(NVGcontext* nvg)
+    {
+        auto it = atlases.find(nvg);
+        return it != atlases.end() ? it->second.get() : nullptr;
+    }
+
+    // Deletes all pages, images in the atlas will notice that they are invalid and render again
+    static void clearAll(NVGcontext* nvg)
+    {
+        if (auto* atlas = findForContext(nvg)) {
+            for (auto& page : atlas->pages) {
+                if (page.imageId)
+                    nvgDeleteImage(nvg, page.imageId);
+            }
+            atlases.erase(nvg);
+        }
+    }
+
+    // Uploads the areas of the pages that changed, needs to be called before nvgEndFrame
+    static void flush(NVGcontext* nvg)
+    {
+        if (auto* atlas = findForContext(nvg)) {
+            // nvgUpdateImage can only upload the whole page, so we go to the renderer directly
+            // Like nvgUpdateImage, it takes the data of the whole image and picks out the region itself
+            auto const* params = nvgInternalParams(nvg);
+            for (auto& page : atlas->pages) {
+                if (page.dirtyAreas.empty())
+                    continue;
+
+                Image::BitmapData pixels(page.pixels, Image::BitmapData::readOnly);
+                for (auto const& area : page.dirtyAreas) {
+                    params->renderUpdateTexture(params->userPtr, page.imageId, area.getX(), area.getY(), area.getWidth(), area.getHeight(), pixels.data);
+                }
+                page.dirtyAreas.clear();
+            }
+            atlas->currentFrame++;
+        }
+    }
+
+    explicit NVGTextureAtlas(NVGcontext* context)
+        : nvg(context)
+    {
+    }
+
+    // Returns an empty location if there is no space left, or if the image is too large to share a page
+    Location add(int width, int height, bool isAlpha, std::function<void(Graphics&)> const& renderCall)
+    {
+        // Keep a transparent border around every image, so linear filtering doesn't pick up its neighbours
+        auto const paddedWidth = width + 2 * padding;
+        auto const paddedHeight = height + 2 * padding;
+        if (width <= 0 || height <= 0 || width > maxImageSize || height > maxImageSize)
+            return {};
+
+        Rectangle<int> slot;
+        auto* page = findPageWithSpace(paddedWidth, paddedHeight, isAlpha, slot);
+        if (!page)
+            return {};
+
+        page->numImages++;
+
+        Location location { static_cast<int>(page - pages.data()), page->generation, slot, slot.reduced(padding) };
+        renderToSlot(*page, location, renderCall);
+        return location;
+    }
+
+    // Renders into the slot the image already has, so changing text doesn't need new space
+    // Returns false if the image doesn't fit in the slot anymore
+    bool update(Location& location, int width, int height, bool isAlpha, std::function<void(Graphics&)> const& renderCall)
+    {
+        if (!isValid(location) || pages[location.page].isAlpha != isAlpha)
+            return false;
+
+        auto const available = location.slot.reduced(padding);
+        if (width <= 0 || height <= 0 || width > available.getWidth() || height > available.getHeight())
+            return false;
+
+        location.bounds = available.withSize(width, height);
+        renderToSlot(pages[location.page], location, renderCall);
+        return true;
+    }
+
+    void remove(Location const& location)
+    {
+        if (!isValid(location))
+            return;
+
+        auto& page = pages[location.page];
+
+        // Once a page has no images left, we can start filling it from the top again
+        if (--page.numImages == 0) {
+            page.shelves.clear();
+            page.generation = nextGeneration++;
+            return;
+        }
+
+        for (auto& shelf : page.shelves) {
+            if (shelf.y == location.slot.getY()) {
+                shelf.release(location.slot.getHorizontalRange());
+                break;
+            }
+        }
+
+        // Give the space of empty shelves at the bottom back to the page, so it can be used for other heights
+        while (!page.shelves.empty() && page.shelves.back().isEmpty())
+            page.shelves.pop_back();
+    }
+
+    bool isValid(Location const& location) const
+    {
+        return isPositiveAndBelow(location.page, static_cast<int>(pages.size())) && pages[location.page].generation == location.generation;
+    }
+
+    // A paint that draws the image stretched over the area
+    NVGpaint getPaint(Location const& location, Rectangle<float> area, NVGcolor colour)
+    {
+        auto& page = pages[location.page];
+        page.lastUsedFrame = currentFrame;
+
+        auto const scaleX = area.getWidth() / location.bounds.getWidth();
+        auto const scaleY = area.getHeight() / location.bounds.getHeight();
+        auto const x = area.getX() - location.bounds.getX() * scaleX;
+        auto const y = area.getY() - location.bounds.getY() * scaleY;
+
+        if (page.isAlpha)
+            return nvgImageAlphaPattern(nvg, x, y, pageSize * scaleX, pageSize * scaleY, 0, page.imageId, colour);
+
+        return nvgImagePattern(nvg, x, y, pageSize * scaleX, pageSize * scaleY, 0, page.imageId, colour.a);
+    }
+
+private:
+    static constexpr int padding = 1;
+    static constexpr int maxDirtyAreas = 8;
+
+    // Shelf packing: images of similar height are placed next to each other in a row
+    // Released slots are kept per shelf, so the space can be used again before the page is empty
+    struct Shelf {
+        int y = 0, height = 0;
+        int usedWidth = 0;                    // Everything to the right of this is free
+        SmallArray<Range<int>, 8> freeRanges; // Released slots to the left of usedWidth
+
+        bool allocate(int width, Range<int>& result)
+        {
+            for (size_t i = 0; i < freeRanges.size(); i++) {
+                if (freeRanges[i].getLength() >= width) {
+                    result = Range<int>::withStartAndLength(freeRanges[i].getStart(), width);
+                    freeRanges[i].setStart(result.getEnd());
+                    if (freeRanges[i].isEmpty())
+                        freeRanges.erase(freeRanges.begin() + i);
+                    return true;
+                }
+            }
+
+            if (usedWidth + width > pageSize)
+                return false;
+
+            result = Range<int>::withStartAndLength(usedWidth, width);
+            usedWidth += width;
+            return true;
+        }
+
+        void release(Range<int> range)
+        {
+            // Merge with neighbouring free space, so it can also fit wider images
+            for (int i = static_cast<int>(freeRanges.size()) - 1; i >= 0; i--) {
+                if (freeRanges[i].getEnd() == range.getStart() || freeRanges[i].getStart() == range.getEnd()) {
+                    range = range.getUnionWith(freeRanges[i]);
+                    freeRanges.erase(freeRanges.begin() + i);
+                }
+            }
+
+            if (range.getEnd() == usedWidth)
+                usedWidth = range.getStart();
+            else
+                freeRanges.add(range);
+        }
+
+        bool isEmpty() const
+        {
+            return usedWidth == 0;
+        }
+    };
+
+    struct Page {
+        int imageId = 0;
+        Image pixels;
+        bool isAlpha = false;
+        SmallArray<Rectangle<int>, maxDirtyAreas> dirtyAreas;
+        SmallArray<Shelf> shelves;
+        int numImages = 0;
+        uint32 generation = 0;
+        uint32 lastUsedFrame = 0;
+
+        bool allocate(int width, int height, Rectangle<int>& result)
+        {
+            Range<int> range;
+
+            // Use a shelf that isn't much higher than the image, text with the same font will always fit
+            for (auto& shelf : shelves) {
+                if (shelf.height >= height && shelf.height <= height + height / 2 && shelf.allocate(width, range)) {
+                    result = { range.getStart(), shelf.y, width, height };
+                    return true;
+                }
+            }
+
+            // Round up the height of new shelves, so images with a slightly different height can share them
+            auto const shelfY = shelves.empty() ? 0 : shelves.back().y + shelves.back().height;
+            auto const shelfHeight = std::min((height + 7) & ~7, pageSize - shelfY);
+            if (shelfHeight < height)
+                return false;
+
+            shelves.add({ shelfY, shelfHeight });
+            shelves.back().allocate(width, range);
+            result = { range.getStart(), shelfY, width, height };
+            return true;
+        }
+
+        void markDirty(Rectangle<int> area)
+        {
+            // Keep the number of uploads low, it's still much smaller than the whole page
+            if (dirtyAreas.size() >= maxDirtyAreas) {
+                for (auto const& dirtyArea : dirtyAreas)
+                    area = area.getUnion(dirtyArea);
+                dirtyAreas.clear();
+            }
+            dirtyAreas.add(area);
+        }
+    };
+
+    void renderToSlot(Page& page, Location const& location, std::function<void(Graphics&)> const& renderCall)
+    {
+        page.lastUsedFrame = currentFrame;
+        page.markDirty(location.slot);
+        page.pixels.clear(location.slot);
+
+        Graphics g(page.pixels);
+        g.reduceClipRegion(location.bounds);
+        g.setOrigin(location.bounds.getPosition());
+        renderCall(g);
+    }
+
+    Page* findPageWithSpace(int width, int height, bool isAlpha, Rectangle<int>& slot)
+    {
+        for (auto& page : pages) {
+            if (page.isAlpha == isAlpha && page.allocate(width, height, slot))
+                return &page;
+        }
+
+        if (static_cast<int>(pages.size()) < maxPages) {
+            pages.emplace_back();
+            auto& page = pages.back();
+            page.isAlpha = isAlpha;
+            page.generation = nextGeneration++;
+            page.pixels = Image(isAlpha ? Image::SingleChannel : Image::ARGB, pageSize, pageSize, true);
+
+            Image::BitmapData pixels(page.pixels, Image::BitmapData::readOnly);
+            if (auto* surface = NVGSurface::getSurfaceForContext(nvg))
+                surface->makeContextActive();
+            page.imageId = isAlpha ? nvgCreateImageAlpha(nvg, pageSize, pageSize, 0, pixels.data) : nvgCreateImageARGB(nvg, pageSize, pageSize, NVG_IMAGE_PREMULTIPLIED, pixels.data);
+            page.allocate(width, height, slot);
+            return &page;
+        }
+
+        // All pages are in use, so we start over on the page that was drawn the longest ago
+        // Pages that were drawn in this frame are never evicted, because their contents still need to be uploaded
+        Page* leastRecentlyUsed = nullptr;
+        for (auto& page : pages) {
+            if (page.isAlpha == isAlpha && page.lastUsedFrame != currentFrame && (!leastRecentlyUsed || page.lastUsedFrame < leastRecentlyUsed->lastUsedFrame))
+                leastRecentlyUsed = &page;
+        }
+
+        if (leastRecentlyUsed) {
+            leastRecentlyUsed->shelves.clear();
+            leastRecentlyUsed->numImages = 0;
+            leastRecentlyUsed->generation = nextGeneration++;
+            leastRecentlyUsed->allocate(width, height, slot);
+        }
+
+        return leastRecentlyUsed;
+    }
+
+    NVGcontext* nvg;
+    HeapArray<Page> pages;
+    uint32 currentFrame = 1;
+
+    // Shared between all atlases, so a location can never match a page that was cleared or belongs to another context
+    static inline uint32 nextGeneration = 1;
+    static inline UnorderedMap<NVGcontext*, std::unique_ptr<NVGTextureAtlas>> atlases;
+};
+
+// An image that lives in the texture atlas of its context
+class NVGAtlasImage {
+public:
+    NVGAtlasImage() = default;
+
+    ~NVGAtlasImage()
+    {
+        release();
+    }
+
+    // Returns false if the image doesn't fit in the atlas, in which case you should fall back to an NVGImage
+    bool render(NVGcontext* context, int width, int height, std::function<void(Graphics&)> const& renderCall, bool alphaImage)
+    {
+        // Re-use the slot we already have if the new image still fits, this only uploads that slot again
+        if (nvg == context) {
+            if (auto* atlas = NVGTextureAtlas::findForContext(nvg); atlas && atlas->update(location, width, height, alphaImage, renderCall))
+                return true;
+        }
+
+        release();
+
+        location = NVGTextureAtlas::getForContext(context)->add(width, height, alphaImage, renderCall);
+        nvg = context;
+        return location.page >= 0;
+    }
+
+    bool isValid() const
+    {
+        auto* atlas = NVGTextureAtlas::findForContext(nvg);
+        return atlas && atlas->isValid(location);
+    }
+
+    // Only call this when isValid() returns true
+    NVGpaint getPaint(Rectangle<float> area, NVGcolor colour) const
+    {
+        return NVGTextureAtlas::findForContext(nvg)->getPaint(location, area, colour);
+    }
+
+    void release()
+    {
+        if (auto* atlas = NVGTextureAtlas::findForContext(nvg))
+            atlas->remove(location);
+
+        location = {};
+    }
+
+private:
+    NVGcontext* nvg = nullptr;
+    NVGTextureAtlas::Location location;
+
+    JUCE_DECLARE_NON_COPYABLE(NVGAtlasImage)
+};
+
 class NVGFramebuffer {
 public:
     NVGFramebuffer()
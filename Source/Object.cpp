@@ -37,6 +37,7 @@ Object::Object(Canvas* parent, String const& name, Point<int> position)
     , editor(parent->editor)
     , ds(parent->dragState)
 {
+    zOrder = cnv->nextZOrder++;
     setTopLeftPosition(position - Point<int>(margin, margin));
 
     initialise();
@@ -60,6 +61,7 @@ Object::Object(pd::WeakReference object, Canvas* parent)
     , editor(parent->editor)
     , ds(parent->dragState)
 {
+    zOrder = cnv->nextZOrder++;
     initialise();
 
     setType("", object);
@@ -69,6 +71,7 @@ Object::~Object()
 {
     hideEditor(); // Make sure the editor is not still open, that could lead to issues with listeners attached to the editor (i.e. suggestioncomponent)
     cnv->selectedComponents.removeChangeListener(this);
+    cnv->objectIndex.remove(this);
 }
 
 Rectangle<int> Object::getObjectBounds()
@@ -496,6 +499,12 @@ void Object::resized()
     }
 
     updateIoletGeometry();
+    cnv->objectIndex.update(this, getBounds());
+}
+
+void Object::moved()
+{
+    cnv->objectIndex.update(this, getBounds());
 }
 
 void Object::updateIoletGeometry()
@@ -682,6 +691,26 @@ void Object::updateTooltips()
 }
 
 void Object::updateIolets()
+{
+    if (!getPointer())
+        return;
+
+    int newNumInputs = 0;
+    int newNumOutputs = 0;
+    SmallArray<uint8, 16> signalIolets;
+    if (auto* ptr = pd::Interface::checkObject(getPointer())) {
+        newNumInputs = pd::Interface::numInlets(ptr);
+        newNumOutputs = pd::Interface::numOutlets(ptr);
+        for (int i = 0; i < newNumInputs; i++)
+            signalIolets.add(pd::Interface::isSignalInlet(ptr, i));
+        for (int i = 0; i < newNumOutputs; i++)
+            signalIolets.add(pd::Interface::isSignalOutlet(ptr, i));
+    }
+
+    updateIolets(newNumInputs, newNumOutputs, signalIolets.data());
+}
+
+void Object::updateIolets(int const newNumInputs, int const newNumOutputs, uint8 const* signalIolets)
 {
     if (!getPointer())
         return;
@@ -694,13 +723,8 @@ void Object::updateIolets()
         iolet->isInlet ? oldNumInputs++ : oldNumOutputs++;
     }
 
-    numInputs = 0;
-    numOutputs = 0;
-
-    if (auto* ptr = pd::Interface::checkObject(getPointer())) {
-        numInputs = pd::Interface::numInlets(ptr);
-        numOutputs = pd::Interface::numOutlets(ptr);
-    }
+    numInputs = newNumInputs;
+    numOutputs = newNumOutputs;
 
     // Looking up tooltips takes a bit of time, so we make sure we're not constantly updating them for no reason
     bool tooltipsNeedUpdate = gui->getPatch() != nullptr || numInputs != oldNumInputs || numOutputs != oldNumOutputs || isGemObject;
@@ -729,13 +753,7 @@ void Object::updateIolets()
         auto* iolet = iolets[i];
         bool input = iolet->isInlet;
 
-        bool isSignal = false;
-        auto* patchableObject = pd::Interface::checkObject(getPointer());
-        if (patchableObject && i < numInputs) {
-            isSignal = pd::Interface::isSignalInlet(patchableObject, i);
-        } else if (patchableObject) {
-            isSignal = pd::Interface::isSignalOutlet(patchableObject, i - numInputs);
-        }
+        bool isSignal = signalIolets && signalIolets[i];
 
         iolet->ioletIdx = input ? numIn : numOut;
         iolet->isSignal = isSignal;
@@ -1214,6 +1232,15 @@ void Object::render(NVGcontext* nvg)
         nvgSmoothGlow(nvg, lb.getX(), lb.getY(), lb.getWidth(), lb.getHeight(), glowColour, nvgRGBA(0, 0, 0, 0), Corners::objectCornerRadius, 1.1f);
     }
 
+    if (cnv->shouldShowCPUUsage()) {
+        // Objects that take 10% of the audio budget or more are drawn fully red
+        auto heat = std::sqrt(jlimit(0.0f, 1.0f, cnv->pd->profiler.getLoad(getPointer()) * 10.0f));
+        if (heat > 0.0f) {
+            auto heatColour = nvgRGBAf(heat, 1.0f - heat, 0.0f, 0.25f + heat * 0.5f);
+            nvgSmoothGlow(nvg, lb.getX(), lb.getY(), lb.getWidth(), lb.getHeight(), heatColour, nvgRGBA(0, 0, 0, 0), Corners::objectCornerRadius, 1.1f);
+        }
+    }
+
     if (gui && gui->isTransparent() && !getValue<bool>(locked) && !cnv->isGraph) {
         nvgFillColor(nvg, cnv->transparentObjectBackgroundCol);
         nvgFillRoundedRect(nvg, b.getX(), b.getY(), b.getWidth(), b.getHeight(), Corners::objectCornerRadius);
@@ -1309,17 +1336,6 @@ void Object::renderIolets(NVGcontext* nvg)
     }
 }
 
-void Object::renderLabel(NVGcontext* nvg)
-{
-    if (gui) {
-        for (auto* label : gui->labels) {
-            NVGScopedState scopedState(nvg);
-            nvgTranslate(nvg, label->getX(), label->getY());
-            label->renderLabel(nvg, cnv->getRenderScale() * 2.0f);
-        }
-    }
-}
-
 // Returns true is the object is showing its initial editor, and doesn't have a GUI yet
 bool Object::isInitialEditorShown()
 {
@@ -53,12 +53,15 @@ public:
     void timerCallback() override;
 
     void resized() override;
+    void moved() override;
 
     void updateIoletGeometry();
 
     bool keyPressed(KeyPress const& key, Component* component) override;
 
     void updateIolets();
+    // Takes the number of iolets and their signal flags, inlets first, so they can come from a patch snapshot
+    void updateIolets(int newNumInputs, int newNumOutputs, uint8 const* signalIolets);
 
     void setType(String const& newType, pd::WeakReference existingObject = nullptr);
     void updateBounds();
@@ -87,7 +90,6 @@ public:
     void render(NVGcontext* nvg) override;
 
     void renderIolets(NVGcontext* nvg);
-    void renderLabel(NVGcontext* nvg);
 
     void mouseMove(MouseEvent const& e) override;
     void mouseDown(MouseEvent const& e) override;
@@ -110,6 +112,9 @@ public:
     int numInputs = 0;
     int numOutputs = 0;
 
+    // Position in the canvas' render order
+    int zOrder = 0;
+
     Value locked;
     Value commandLocked;
     Value presentationMode;
@@ -132,6 +137,9 @@ public:
 
     Rectangle<int> originalBounds;
 
+    // Bounds of the object in Pd when the canvas was last synchronised, so we only ask the gui for its bounds when they changed
+    Rectangle<int> lastSynchronisedBounds;
+
     static inline int const minimumSize = 9;
 
     bool isSelected() const;
@@ -525,8 +525,7 @@ public:
         addAndMakeVisible(graph);
 
         graph.graphChangeCallback = [this](float a1, float a2, float b0, float b1, float b2) {
-            if (auto obj = ptr.get<void>())
-                pd->sendDirectMessage(obj.get(), "biquad", { a1, a2, b0, b1, b2 });
+            pd->sendDirectMessage(ptr, "biquad", { a1, a2, b0, b1, b2 });
         };
 
         objectParameters.addParamSize(&sizeProperty);
@@ -579,8 +578,9 @@ public:
 
             setParameterExcludingListener(sizeProperty, VarArray { var(width), var(height) });
 
+            // updateBounds reads the size back from Pd, so it has to be applied right away
             if (auto gobj = ptr.get<t_gobj>()) {
-                pd->sendDirectMessage(gobj.get(), "dim", { (float)width, (float)height });
+                pd->sendDirectMessageNow(gobj.get(), "dim", { (float)width, (float)height });
             }
 
             object->updateBounds();
@@ -605,7 +605,7 @@ public:
         if (auto gobj = ptr.get<t_gobj>()) {
             auto* patch = object->cnv->patch.getRawPointer();
             pd::Interface::moveObject(patch, gobj.get(), b.getX(), b.getY());
-            pd->sendDirectMessage(gobj.get(), "dim", { (float)b.getWidth() - 1, (float)b.getHeight() - 1 });
+            pd->sendDirectMessageNow(gobj.get(), "dim", { (float)b.getWidth() - 1, (float)b.getHeight() - 1 });
         }
 
         graph.saveProperties();
@@ -409,12 +409,10 @@ public:
                 repaint();
             } else if (v.refersToSameSourceAs(sendSymbol)) {
                 auto symbol = sendSymbol.toString();
-                if (auto obj = ptr.get<void>())
-                    pd->sendDirectMessage(obj.get(), "send", { pd->generateSymbol(symbol) });
+                pd->sendDirectMessage(ptr, "send", { pd->generateSymbol(symbol) });
             } else if (v.refersToSameSourceAs(receiveSymbol)) {
                 auto symbol = receiveSymbol.toString();
-                if (auto obj = ptr.get<void>())
-                    pd->sendDirectMessage(obj.get(), "receive", { pd->generateSymbol(symbol) });
+                pd->sendDirectMessage(ptr, "receive", { pd->generateSymbol(symbol) });
 
             } else if (v.refersToSameSourceAs(range)) {
                 setRange(getRange());
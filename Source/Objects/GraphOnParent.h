@@ -29,6 +29,7 @@ public:
         : ObjectBase(obj, object)
         , subpatch(new pd::Patch(obj, cnv->pd, false))
     {
+        cnv->framebufferObjects.add(this);
         resized();
 
         objectParameters.addParamSize(&sizeProperty);
@@ -223,6 +224,7 @@ public:
 
     ~GraphOnParent() override
     {
+        cnv->framebufferObjects.remove_one(this);
         closeOpenedSubpatchers();
     }
 
@@ -259,6 +261,7 @@ public:
     {
         if (!canvas) {
             canvas = std::make_unique<Canvas>(cnv->editor, subpatch, this);
+            canvas->graphObject = this;
 
             // Make sure that the graph doesn't become the current canvas
             cnv->patch.setCurrent();
@@ -367,12 +370,8 @@ public:
 
     void updateFramebuffers() override
     {
-        if (canvas) {
-            for (auto& object : canvas->objects) {
-                if (object->gui)
-                    object->gui->updateFramebuffers();
-            }
-        }
+        if (canvas)
+            canvas->updateObjectFramebuffers();
     }
 
     static void drawTicksForGraph(NVGcontext* nvg, t_glist* x, ObjectBase* parent)
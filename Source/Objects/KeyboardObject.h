@@ -231,16 +231,13 @@ public:
             object->updateBounds();
         } else if (value.refersToSameSourceAs(sendSymbol)) {
             auto symbol = sendSymbol.toString();
-            if (auto obj = ptr.get<void>())
-                pd->sendDirectMessage(obj.get(), "send", { pd->generateSymbol(symbol) });
+            pd->sendDirectMessage(ptr, "send", { pd->generateSymbol(symbol) });
         } else if (value.refersToSameSourceAs(receiveSymbol)) {
             auto symbol = receiveSymbol.toString();
-            if (auto obj = ptr.get<void>())
-                pd->sendDirectMessage(obj.get(), "receive", { pd->generateSymbol(symbol) });
+            pd->sendDirectMessage(ptr, "receive", { pd->generateSymbol(symbol) });
         } else if (value.refersToSameSourceAs(toggleMode)) {
             auto toggle = getValue<int>(toggleMode);
-            if (auto obj = ptr.get<void>())
-                pd->sendDirectMessage(obj.get(), "toggle", { (float)toggle });
+            pd->sendDirectMessage(ptr, "toggle", { (float)toggle });
         }
     }
 
@@ -309,14 +309,14 @@ public:
         } else if (key.getKeyCode() == KeyPress::upKey || key.getKeyCode() == KeyPress::rightKey) {
             if (auto knob = ptr.get<t_fake_knob>()) {
                 knob->x_clicked = 1;
-                pd->sendDirectMessage(knob.cast<void>(), "list", { pd::Atom(1.0f), pd::Atom(gensym("Up")) });
+                pd->sendDirectMessageNow(knob.cast<void>(), "list", { pd::Atom(1.0f), pd::Atom(gensym("Up")) });
                 knob->x_clicked = 0;
             }
             return true;
         } else if (key.getKeyCode() == KeyPress::downKey || key.getKeyCode() == KeyPress::leftKey) {
             if (auto knob = ptr.get<t_fake_knob>()) {
                 knob->x_clicked = 1;
-                pd->sendDirectMessage(knob.cast<void>(), "list", { pd::Atom(1.0f), pd::Atom(gensym("Down")) });
+                pd->sendDirectMessageNow(knob.cast<void>(), "list", { pd::Atom(1.0f), pd::Atom(gensym("Down")) });
                 knob->x_clicked = 0;
             }
             return true;
@@ -621,16 +621,12 @@ public:
 
     void setSendSymbol(String const& symbol) const
     {
-        if (auto knob = ptr.get<void>()) {
-            pd->sendDirectMessage(knob.get(), "send", { pd::Atom(pd->generateSymbol(symbol)) });
-        }
+        pd->sendDirectMessage(ptr, "send", { pd::Atom(pd->generateSymbol(symbol)) });
     }
 
     void setReceiveSymbol(String const& symbol) const
     {
-        if (auto knob = ptr.get<void>()) {
-            pd->sendDirectMessage(knob.get(), "receive", { pd::Atom(pd->generateSymbol(symbol)) });
-        }
+        pd->sendDirectMessage(ptr, "receive", { pd::Atom(pd->generateSymbol(symbol)) });
     }
 
     Colour getBackgroundColour() const
@@ -846,15 +842,11 @@ public:
             updateRange();
         } else if (value.refersToSameSourceAs(angularRange)) {
             auto range = limitValueRange(angularRange, 0, 360);
-            if (auto knb = ptr.get<t_fake_knob>()) {
-                pd->sendDirectMessage(knb.get(), "angle", { pd::Atom(range) });
-            }
+            pd->sendDirectMessage(ptr, "angle", { pd::Atom(range) });
             updateRotaryParameters();
         } else if (value.refersToSameSourceAs(angularOffset)) {
             auto offset = limitValueRange(angularOffset, -180, 180);
-            if (auto knb = ptr.get<t_fake_knob>()) {
-                pd->sendDirectMessage(knb.get(), "offset", { pd::Atom(offset) });
-            }
+            pd->sendDirectMessage(ptr, "offset", { pd::Atom(offset) });
             updateRotaryParameters();
         } else if (value.refersToSameSourceAs(showArc)) {
             bool arc = ::getValue<bool>(showArc);
@@ -239,8 +239,7 @@ public:
 
     void setList(SmallArray<pd::Atom> const& value)
     {
-        if (auto gatom = ptr.get<t_fake_gatom>())
-            cnv->pd->sendDirectMessage(gatom.get(), SmallArray<pd::Atom>(value.begin(), value.end()));
+        cnv->pd->sendDirectMessage(ptr, SmallArray<pd::Atom>(value.begin(), value.end()));
     }
 
     void mouseUp(MouseEvent const& e) override
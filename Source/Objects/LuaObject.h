@@ -77,6 +77,9 @@ public:
             allDrawTargets[pdlua.get()].add(this);
         }
 
+        cnv->framebufferObjects.add(this);
+        setFramebuffersDirty();
+
         parentHierarchyChanged();
     }
 
@@ -86,7 +89,8 @@ public:
         auto& listeners = allDrawTargets[ptr.getRawUnchecked<t_pdlua>()];
         listeners.erase(std::remove(listeners.begin(), listeners.end(), this), listeners.end());
         pd->unlockAudioThread();
-        
+
+        cnv->framebufferObjects.remove_one(this);
         zoomScale.removeListener(this);
     }
 
@@ -143,9 +147,7 @@ public:
         menu.addItem("Open lua editor", [_this = SafePointer(this)]() {
             if (!_this)
                 return;
-            if (auto obj = _this->ptr.get<t_pd>()) {
-                _this->pd->sendDirectMessage(obj.get(), "menu-open", {});
-            }
+            _this->pd->sendDirectMessage(_this->ptr, "menu-open", {});
         });
         menu.addItem("Reload lua object", [_this = SafePointer(this)]() {
             if (!_this)
@@ -215,9 +217,15 @@ public:
 
     void render(NVGcontext* nvg) override
     {
+        // We need to ask Lua to paint again when the selection changed or when our framebuffers got lost
+        auto needsRepaint = isSelected != object->isSelected();
         for (auto& [layer, fb] : framebuffers) {
+            needsRepaint = needsRepaint || !fb.isValid();
             fb.render(nvg, Rectangle<int>(getWidth() + 1, getHeight()));
         }
+
+        if (needsRepaint)
+            setFramebuffersDirty();
     }
 
     void valueChanged(Value& v) override
@@ -543,6 +551,7 @@ public:
     {
         for (auto* object : allDrawTargets[static_cast<t_pdlua*>(target)]) {
             object->guiMessageQueue[layer].enqueue({ sym, argc, argv });
+            object->setFramebuffersDirty();
         }
     }
 
@@ -649,9 +658,7 @@ public:
         menu.addItem("Open lua editor", [_this = SafePointer(this)]() {
             if (!_this)
                 return;
-            if (auto obj = _this->ptr.get<t_pd>()) {
-                _this->pd->sendDirectMessage(obj.get(), "menu-open", {});
-            }
+            _this->pd->sendDirectMessage(_this->ptr, "menu-open", {});
         });
 
         menu.addItem("Reload lua object", [_this = SafePointer(this)]() {
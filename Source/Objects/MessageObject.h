@@ -277,9 +277,7 @@ public:
 
     void click()
     {
-        if (auto message = ptr.get<void>()) {
-            cnv->pd->sendDirectMessage(message.get(), 0);
-        }
+        cnv->pd->sendDirectMessage(ptr, 0);
     }
 
     void mouseUp(MouseEvent const& e) override
@@ -385,9 +385,7 @@ public:
             repaint();
         } else if (v.refersToSameSourceAs(receiveSymbol)) {
             auto receive = receiveSymbol.toString();
-            if (auto note = ptr.get<t_fake_note>()) {
-                pd->sendDirectMessage(note.get(), "receive", { pd->generateSymbol(receive) });
-            }
+            pd->sendDirectMessage(ptr, "receive", { pd->generateSymbol(receive) });
         } else if (v.refersToSameSourceAs(justification)) {
             auto justificationType = getValue<int>(justification);
             if (auto note = ptr.get<t_fake_note>())
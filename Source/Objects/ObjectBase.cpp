@@ -448,6 +448,15 @@ void ObjectBase::moveToBack()
     }
 }
 
+void ObjectBase::setFramebuffersDirty()
+{
+    framebuffersDirty = true;
+
+    // Objects inside a graph get updated by the graph
+    if (auto* graph = cnv->graphObject)
+        graph->setFramebuffersDirty();
+}
+
 void ObjectBase::render(NVGcontext* nvg)
 {
     imageRenderer.renderJUCEComponent(nvg, *this, getImageScale());
@@ -505,8 +514,9 @@ void ObjectBase::startEdition()
         return;
 
     edited = true;
-    if (auto lockedPtr = ptr.get<void>()) {
-        pd->sendMessage("gui", "mouse", { 1.f });
+    // Queued, so it arrives in order with the values we send while editing
+    if (ptr.isValid()) {
+        pd->sendQueuedMessage("gui", "mouse", { 1.f });
     }
 }
 
@@ -516,20 +526,16 @@ void ObjectBase::stopEdition()
         return;
 
     edited = false;
-    if (auto lockedPtr = ptr.get<void>()) {
-        pd->sendMessage("gui", "mouse", { 0.f });
+    // Queued, so it arrives in order with the values we send while editing
+    if (ptr.isValid()) {
+        pd->sendQueuedMessage("gui", "mouse", { 0.f });
     }
 }
 
 void ObjectBase::sendFloatValue(float newValue)
 {
-    t_atom atom;
-    SETFLOAT(&atom, newValue);
-
-    if (auto obj = ptr.get<t_pd>()) {
-        pd_typedmess(obj.get(), cnv->patch.instance->generateSymbol("set"), 1, &atom);
-        pd_bang(obj.get());
-    }
+    pd->sendDirectMessage(ptr, "set", { newValue });
+    pd->sendDirectMessage(ptr, "bang", {});
 }
 
 ObjectBase* ObjectBase::createGui(pd::WeakReference ptr, Object* parent)
@@ -700,9 +706,7 @@ void ObjectBase::getMenuOptions(PopupMenu& menu)
             menu.addItem("Open", [_this = SafePointer(this)]() {
                 if (!_this)
                     return;
-                if (auto obj = _this->ptr.get<t_pd>()) {
-                    _this->pd->sendDirectMessage(obj.get(), "menu-open", {});
-                }
+                _this->pd->sendDirectMessage(_this->ptr, "menu-open", {});
             });
         } else {
             menu.addItem(-1, "Open", false);
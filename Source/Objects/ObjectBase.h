@@ -45,6 +45,29 @@ public:
         setInterceptsMouseClicks(false, false);
     }
 
+    ~ObjectLabel() override
+    {
+        if (indexedCanvas)
+            indexedCanvas->labelIndex.remove(this);
+    }
+
+    void moved() override
+    {
+        updateIndex();
+    }
+
+    void resized() override
+    {
+        Label::resized();
+        updateIndex();
+    }
+
+    void parentHierarchyChanged() override
+    {
+        Label::parentHierarchyChanged();
+        updateIndex();
+    }
+
     virtual void renderLabel(NVGcontext* nvg, float scale)
     {
         auto textHash = hash(getText());
@@ -74,6 +97,19 @@ public:
     }
 
 private:
+    // Labels are drawn by the canvas they're placed on, which only looks up labels in the invalidated area
+    void updateIndex()
+    {
+        auto* cnv = dynamic_cast<Canvas*>(getParentComponent());
+        if (indexedCanvas && indexedCanvas != cnv)
+            indexedCanvas->labelIndex.remove(this);
+
+        indexedCanvas = cnv;
+        if (cnv)
+            cnv->labelIndex.update(this, getBounds());
+    }
+
+    Component::SafePointer<Canvas> indexedCanvas;
 };
 
 class ObjectBase : public Component
@@ -156,8 +192,12 @@ public:
     virtual bool hideInGraph();
 
     // Override function if you need to update framebuffers outside of the render loop (but with the correct active context)
+    // The object needs to be in cnv->framebufferObjects, and this only gets called after setFramebuffersDirty()
     virtual void updateFramebuffers() { };
 
+    // Safe to call from any thread
+    void setFramebuffersDirty();
+
     // Most objects ignore mouseclicks when locked
     // Objects can override this to do custom locking behaviour
     virtual void lock(bool isLocked);
@@ -286,6 +326,8 @@ public:
 
     OwnedArray<ObjectLabel> labels;
 
+    std::atomic<bool> framebuffersDirty = false;
+
 protected:
     String type;
     float lastImageScale = 2.0f;
@@ -76,8 +76,7 @@ public:
         if (type == Key) {
             t_symbol* dummy;
             parseKey(keyCode, dummy);
-            if (auto obj = ptr.get<t_pd>())
-                pd->sendDirectMessage(obj.get(), keyCode);
+            pd->sendDirectMessage(ptr, keyCode);
         } else if (type == KeyName) {
 
             String keyString = key.getTextDescription().fromLastOccurrenceOf(" ", false, false);
@@ -92,8 +91,7 @@ public:
             t_symbol* keysym = pd->generateSymbol(keyString);
             parseKey(keyCode, keysym);
 
-            if (auto obj = ptr.get<t_pd>())
-                pd->sendDirectMessage(obj.get(), { 1.0f, keysym });
+            pd->sendDirectMessage(ptr, { 1.0f, keysym });
         }
 
         // Never claim the keypress
@@ -154,8 +152,7 @@ public:
                     if (type == KeyUp) {
                         t_symbol* dummy;
                         parseKey(keyCode, dummy);
-                        if (auto obj = ptr.get<t_pd>())
-                            pd->sendDirectMessage(obj.get(), keyCode);
+                        pd->sendDirectMessage(ptr, keyCode);
                     } else if (type == KeyName) {
 
                         String keyString = key.getTextDescription().fromLastOccurrenceOf(" ", false, false);
@@ -169,8 +166,7 @@ public:
 
                         t_symbol* keysym = pd->generateSymbol(keyString);
                         parseKey(keyCode, keysym);
-                        if (auto obj = ptr.get<t_pd>())
-                            pd->sendDirectMessage(obj.get(), { 0.0f, keysym });
+                        pd->sendDirectMessage(ptr, { 0.0f, keysym });
                     }
 
                     keyPressTimes.remove_at(n);
@@ -579,32 +575,24 @@ public:
         if (lastPosition != mouseSource.getScreenPosition()) {
 
             auto pos = mouseSource.getScreenPosition();
-            if (auto obj = ptr.get<void>()) {
-                pd->sendDirectMessage(obj.get(), "_getscreen", { pos.x, pos.y });
-            }
+            pd->sendDirectMessage(ptr, "_getscreen", { pos.x, pos.y });
 
             lastPosition = pos;
         }
         if (mouseSource.isDragging()) {
             if (!isDown) {
-                if (auto obj = ptr.get<void>()) {
-                    pd->sendDirectMessage(obj.get(), "_up", { 0.0f });
-                }
+                pd->sendDirectMessage(ptr, "_up", { 0.0f });
             }
             isDown = true;
             lastMouseDownTime = mouseSource.getLastMouseDownTime();
         } else if (mouseSource.getLastMouseDownTime() > lastMouseDownTime) {
             if (!isDown) {
-                if (auto obj = ptr.get<void>()) {
-                    pd->sendDirectMessage(obj.get(), "_up", { 0.0f });
-                }
+                pd->sendDirectMessage(ptr, "_up", { 0.0f });
             }
             isDown = true;
             lastMouseDownTime = mouseSource.getLastMouseDownTime();
         } else if (isDown) {
-            if (auto obj = ptr.get<void>()) {
-                pd->sendDirectMessage(obj.get(), "_up", { 1.0f });
-            }
+            pd->sendDirectMessage(ptr, "_up", { 1.0f });
             isDown = false;
         }
     }
@@ -209,8 +209,6 @@ public:
         if (!getValue<bool>(object->locked) && !getValue<bool>(object->commandLocked))
             return;
 
-        if (auto openfile = ptr.get<void>()) {
-            pd->sendDirectMessage(openfile.get(), "bang", SmallArray<pd::Atom> {});
-        }
+        pd->sendDirectMessage(ptr, "bang", SmallArray<pd::Atom> {});
     }
 };
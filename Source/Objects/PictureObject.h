@@ -217,12 +217,10 @@ public:
                 pic->x_size = getValue<int>(reportSize);
         } else if (value.refersToSameSourceAs(sendSymbol)) {
             auto symbol = sendSymbol.toString();
-            if (auto pic = ptr.get<t_pd>())
-                pd->sendDirectMessage(pic.get(), "send", { pd->generateSymbol(symbol) });
+            pd->sendDirectMessage(ptr, "send", { pd->generateSymbol(symbol) });
         } else if (value.refersToSameSourceAs(receiveSymbol)) {
             auto symbol = receiveSymbol.toString();
-            if (auto pic = ptr.get<t_pd>())
-                pd->sendDirectMessage(pic.get(), "receive", { pd->generateSymbol(symbol) });
+            pd->sendDirectMessage(ptr, "receive", { pd->generateSymbol(symbol) });
         }
     }
 
@@ -117,9 +117,7 @@ public:
 
     void setSymbol(String const& value)
     {
-        if (auto gatom = ptr.get<t_fake_gatom>()) {
-            cnv->pd->sendDirectMessage(gatom.get(), SmallString(value));
-        }
+        cnv->pd->sendDirectMessage(ptr, SmallString(value));
     }
 
     String getSymbol()
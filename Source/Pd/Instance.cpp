@@ -131,6 +131,7 @@ Instance::~Instance()
     pd_free(static_cast<t_pd*>(printReceiver));
     pd_free(static_cast<t_pd*>(parameterReceiver));
     pd_free(static_cast<t_pd*>(pluginLatencyReceiver));
+    pd_free(static_cast<t_pd*>(playheadReceiver));
     pd_free(static_cast<t_pd*>(parameterChangeReceiver));
     pd_free(static_cast<t_pd*>(parameterCreateReceiver));
     pd_free(static_cast<t_pd*>(parameterDestroyReceiver));
@@ -191,6 +192,9 @@ void Instance::initialisePd(String& pdlua_version)
     pluginLatencyReceiver = pd::Setup::createReceiver(this, "latency_compensation", reinterpret_cast<t_plugdata_banghook>(internal::instance_multi_bang), reinterpret_cast<t_plugdata_floathook>(internal::instance_multi_float), reinterpret_cast<t_plugdata_symbolhook>(internal::instance_multi_symbol),
         reinterpret_cast<t_plugdata_listhook>(internal::instance_multi_list), reinterpret_cast<t_plugdata_messagehook>(internal::instance_multi_message));
 
+    playheadReceiver = pd::Setup::createReceiver(this, "playhead_request", reinterpret_cast<t_plugdata_banghook>(internal::instance_multi_bang), reinterpret_cast<t_plugdata_floathook>(internal::instance_multi_float), reinterpret_cast<t_plugdata_symbolhook>(internal::instance_multi_symbol),
+        reinterpret_cast<t_plugdata_listhook>(internal::instance_multi_list), reinterpret_cast<t_plugdata_messagehook>(internal::instance_multi_message));
+
     // JYG added This
     dataBufferReceiver = pd::Setup::createReceiver(this, "to_daw_databuffer", reinterpret_cast<t_plugdata_banghook>(internal::instance_multi_bang), reinterpret_cast<t_plugdata_floathook>(internal::instance_multi_float), reinterpret_cast<t_plugdata_symbolhook>(internal::instance_multi_symbol),
         reinterpret_cast<t_plugdata_listhook>(internal::instance_multi_list), reinterpret_cast<t_plugdata_messagehook>(internal::instance_multi_message));
@@ -435,10 +439,45 @@ void Instance::releaseDSP()
     unlockAudioThread();
 }
 
-void Instance::performDSP(float const* inputs, float* outputs)
+void Instance::performDSP(t_sample const* inputs, t_sample* outputs)
 {
     libpd_set_instance(static_cast<t_pdinstance*>(instance));
+
+    if (EXPECT_UNLIKELY(profiler.isActive())) {
+        lockAudioThread();
+        profiler.prepareTick();
+        unlockAudioThread();
+    }
+
+#if PD_FLOATSIZE == 64
+    libpd_process_raw_double(inputs, outputs);
+#else
     libpd_process_raw(inputs, outputs);
+#endif
+}
+
+Instance::DSPBuffers Instance::getDSPBuffers()
+{
+    libpd_set_instance(static_cast<t_pdinstance*>(instance));
+    return { STUFF->st_soundin, STUFF->st_soundout, STUFF->st_inchannels, STUFF->st_outchannels };
+}
+
+void Instance::performDSP()
+{
+    libpd_set_instance(static_cast<t_pdinstance*>(instance));
+
+    if (EXPECT_UNLIKELY(profiler.isActive())) {
+        lockAudioThread();
+        profiler.prepareTick();
+        unlockAudioThread();
+    }
+
+    // Same as libpd_process_raw, without copying the input in and the output out
+    sys_lock();
+    sys_pollgui();
+    std::fill_n(STUFF->st_soundout, STUFF->st_outchannels * DEFDACBLKSIZE, t_sample(0));
+    sched_tick();
+    sys_unlock();
 }
 
 void Instance::sendNoteOn(int const channel, int const pitch, int const velocity) const
@@ -560,7 +599,7 @@ void Instance::sendMessage(char const* receiver, char const* msg, SmallArray<Ato
     sendTypedMessage(generateSymbol(receiver)->s_thing, msg, list);
 }
 
-void Instance::processSend(dmessage mess)
+void Instance::processSend(dmessage const& mess)
 {
     if (auto obj = mess.object.get<t_pd>()) {
         if (mess.selector == "list") {
@@ -598,34 +637,17 @@ void Instance::unregisterMessageListener(MessageListener* messageListener)
 
 void Instance::registerWeakReference(void* ptr, pd_weak_reference* ref)
 {
-    weakReferenceLock.enter();
-    pdWeakReferences[ptr].add(ref);
-    weakReferenceLock.exit();
+    weakReferences.registerReference(ptr, ref);
 }
 
-void Instance::unregisterWeakReference(void* ptr, pd_weak_reference const* ref)
+void Instance::unregisterWeakReference(void* ptr, pd_weak_reference* ref)
 {
-    weakReferenceLock.enter();
-
-    auto& refs = pdWeakReferences[ptr];
-
-    auto it = std::find(refs.begin(), refs.end(), ref);
-
-    if (it != refs.end()) {
-        refs.erase(it);
-    }
-
-    weakReferenceLock.exit();
+    weakReferences.unregisterReference(ptr, ref);
 }
 
 void Instance::clearWeakReferences(void* ptr)
 {
-    weakReferenceLock.enter();
-    for (auto* ref : pdWeakReferences[ptr]) {
-        *ref = false;
-    }
-    pdWeakReferences.erase(ptr);
-    weakReferenceLock.exit();
+    weakReferences.clearReferences(ptr);
 }
 
 void Instance::enqueueFunctionAsync(std::function<void(void)> const& fn)
@@ -646,31 +668,84 @@ void Instance::enqueueGuiMessage(Message const& message)
     }
 }
 
-void Instance::sendDirectMessage(void* object, SmallString const& msg, SmallArray<Atom>&& list)
+void Instance::enqueueDirectMessage(WeakReference const& object, SmallString const& destination, SmallString const& selector, SmallArray<pd::Atom>&& list)
 {
+    // Only the message thread is allowed to produce into the queue, other threads fall back to locking
+    if (MessageManager::existsAndIsCurrentThread()) {
+        if (directMessageQueue.push(object, destination, selector, std::move(list)))
+            return;
+    }
+
+    // Queue is full (or we're on the wrong thread): flush everything that's pending, so the message order is preserved
     lockAudioThread();
-    processSend(dmessage(this, object, SmallString(), msg, std::move(list)));
+    sendDirectMessagesFromQueue();
+    processSend(dmessage(object, destination, selector, std::move(list)));
     unlockAudioThread();
 }
 
+void Instance::sendDirectMessage(WeakReference const& object, SmallString const& msg, SmallArray<Atom>&& list)
+{
+    enqueueDirectMessage(object, SmallString(), msg, std::move(list));
+}
+
+void Instance::sendDirectMessage(WeakReference const& object, SmallArray<Atom>&& list)
+{
+    enqueueDirectMessage(object, SmallString(), "list", std::move(list));
+}
+
+void Instance::sendDirectMessage(WeakReference const& object, SmallString const& msg)
+{
+    enqueueDirectMessage(object, SmallString(), "symbol", SmallArray<Atom>(1, generateSymbol(msg)));
+}
+
+void Instance::sendDirectMessage(WeakReference const& object, float const msg)
+{
+    enqueueDirectMessage(object, SmallString(), "float", SmallArray<Atom>(1, msg));
+}
+
+void Instance::sendDirectMessage(void* object, SmallString const& msg, SmallArray<Atom>&& list)
+{
+    sendDirectMessage(WeakReference(object, this), msg, std::move(list));
+}
+
 void Instance::sendDirectMessage(void* object, SmallArray<Atom>&& list)
 {
-    lockAudioThread();
-    processSend(dmessage(this, object, SmallString(), "list", std::move(list)));
-    unlockAudioThread();
+    sendDirectMessage(WeakReference(object, this), std::move(list));
 }
 
 void Instance::sendDirectMessage(void* object, SmallString const& msg)
 {
-    lockAudioThread();
-    processSend(dmessage(this, object, SmallString(), "symbol", SmallArray<Atom>(1, generateSymbol(msg))));
-    unlockAudioThread();
+    sendDirectMessage(WeakReference(object, this), msg);
 }
 
 void Instance::sendDirectMessage(void* object, float const msg)
 {
+    sendDirectMessage(WeakReference(object, this), msg);
+}
+
+void Instance::sendQueuedMessage(SmallString const& receiver, SmallString const& msg, SmallArray<Atom>&& list)
+{
+    enqueueDirectMessage(WeakReference(this), receiver, msg, std::move(list));
+}
+
+void Instance::sendDirectMessageNow(void* object, SmallString const& msg, SmallArray<Atom>&& list)
+{
+    sendDirectMessagesFromQueue();
+    processSend(dmessage(this, object, SmallString(), msg, std::move(list)));
+}
+
+// Called from the audio thread at the start of each Pd block, or from the message thread when audio isn't running
+// The audio lock makes sure there is only ever a single consumer
+void Instance::sendDirectMessagesFromQueue()
+{
+    if (directMessageQueue.isEmpty())
+        return;
+
     lockAudioThread();
-    processSend(dmessage(this, object, String(), "float", SmallArray<Atom>(1, msg)));
+    setThis();
+    directMessageQueue.popAll([this](dmessage const& message) {
+        processSend(message);
+    });
     unlockAudioThread();
 }
 
@@ -691,6 +766,14 @@ void Instance::handleAsyncUpdate()
                 performLatencyCompensationChange(mess.list[0].getFloat());
             }
             break;
+        case hash("playhead_request"):
+            // bang: send the full playhead state again, float: turn per-tick position updates on or off
+            if (mess.selector == "bang") {
+                requestPlayheadRefresh();
+            } else if (mess.list.size() == 1 && mess.list[0].isFloat()) {
+                setPlayheadInterpolation(mess.list[0].getFloat() != 0.0f);
+            }
+            break;
         case hash("param"):
             if (mess.list.size() >= 2) {
                 if (!mess.list[0].isSymbol() || !mess.list[1].isFloat())
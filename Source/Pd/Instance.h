@@ -15,6 +15,7 @@ extern "C" {
 #include <readerwriterqueue.h>
 #include "Utility/CachedStringWidth.h"
 #include "Patch.h"
+#include "Profiler.h"
 
 class ObjectImplementationManager;
 
@@ -176,12 +177,70 @@ class Instance : public AsyncUpdater {
         {
         }
 
+        dmessage(WeakReference const& ref, SmallString dest, SmallString sel, SmallArray<pd::Atom> atoms)
+            : object(ref)
+            , destination(dest)
+            , selector(sel)
+            , list(std::move(atoms))
+        {
+        }
+
         WeakReference object;
         SmallString destination;
         SmallString selector;
         SmallArray<pd::Atom> list;
     };
 
+    // Wait-free single-producer single-consumer ring for messages from the GUI to Pd objects
+    // The message thread is the only producer. The consumer is whoever holds the audio lock, which is normally the audio thread at a Pd block boundary
+    // Slots are only destroyed by the producer when it wraps around, so the consumer never has to free any memory
+    class DirectMessageQueue {
+    public:
+        static constexpr uint64 capacity = 1 << 10;
+
+        DirectMessageQueue()
+            : slots(capacity)
+        {
+        }
+
+        // Returns false if the queue is full
+        template<typename... Args>
+        bool push(Args&&... args)
+        {
+            auto const write = writeIndex.load(std::memory_order_relaxed);
+            if (write - readIndex.load(std::memory_order_acquire) >= capacity)
+                return false;
+
+            auto& slot = slots[write & (capacity - 1)];
+            slot.reset();
+            slot.emplace(std::forward<Args>(args)...);
+
+            writeIndex.store(write + 1, std::memory_order_release);
+            return true;
+        }
+
+        template<typename Callback>
+        void popAll(Callback const& callback)
+        {
+            auto read = readIndex.load(std::memory_order_relaxed);
+            auto const write = writeIndex.load(std::memory_order_acquire);
+            while (read != write) {
+                callback(*slots[read & (capacity - 1)]);
+                readIndex.store(++read, std::memory_order_release);
+            }
+        }
+
+        bool isEmpty() const
+        {
+            return readIndex.load(std::memory_order_acquire) == writeIndex.load(std::memory_order_acquire);
+        }
+
+    private:
+        HeapArray<std::optional<dmessage>> slots;
+        AtomicValue<uint64> writeIndex = 0;
+        AtomicValue<uint64> readIndex = 0;
+    };
+
 public:
     explicit Instance();
     Instance(Instance const& other) = delete;
@@ -191,7 +250,34 @@ public:
     void prepareDSP(int nins, int nouts, double samplerate, int blockSize);
     void startDSP();
     void releaseDSP();
-    void performDSP(float const* inputs, float* outputs);
+    // Buffers hold one Pd block per channel, in Pd's own sample type: double when Pd is built with PD_FLOATSIZE=64
+    void performDSP(t_sample const* inputs, t_sample* outputs);
+
+    // Pd's own audio buffers, with one block per channel
+    // adc~ and dac~ compile these addresses into the DSP chain, so they only change when prepareDSP() is called
+    struct DSPBuffers {
+        t_sample* inputs;
+        t_sample* outputs;
+        int numInputs;
+        int numOutputs;
+    };
+    DSPBuffers getDSPBuffers();
+
+    // Processes one block, reading input from and leaving output in the buffers from getDSPBuffers()
+    // This saves the copy through an intermediate buffer that the other overload needs
+    void performDSP();
+
+    // Copies audio into or out of Pd's buffers, only converting when the sample types differ
+    template<typename Destination, typename Source>
+    static void copySamples(Destination* destination, Source const* source, int numSamples)
+    {
+        if constexpr (std::is_same_v<Destination, Source>) {
+            FloatVectorOperations::copy(destination, source, numSamples);
+        } else {
+            for (int i = 0; i < numSamples; i++)
+                destination[i] = static_cast<Destination>(source[i]);
+        }
+    }
     static int getBlockSize();
 
     void handleAsyncUpdate() override;
@@ -233,7 +319,7 @@ public:
     void unregisterMessageListener(MessageListener* messageListener);
 
     void registerWeakReference(void* ptr, pd_weak_reference* ref);
-    void unregisterWeakReference(void* ptr, pd_weak_reference const* ref);
+    void unregisterWeakReference(void* ptr, pd_weak_reference* ref);
     void clearWeakReferences(void* ptr);
 
     static void registerLuaClass(char const* object);
@@ -259,11 +345,28 @@ public:
         });
     }
 
+    // Messages to Pd objects from the GUI. These don't lock the audio thread, but get sent at the start of the next Pd block
+    // The object is only checked when the message gets sent, so there is no need to lock it first
+    void sendDirectMessage(WeakReference const& object, SmallString const& msg, SmallArray<Atom>&& list);
+    void sendDirectMessage(WeakReference const& object, SmallArray<pd::Atom>&& list);
+    void sendDirectMessage(WeakReference const& object, SmallString const& msg);
+    void sendDirectMessage(WeakReference const& object, float msg);
+
+    // Same as above, for when you only have a pointer. Only use these while holding the audio lock, so the object is known to be valid
     void sendDirectMessage(void* object, SmallString const& msg, SmallArray<Atom>&& list);
     void sendDirectMessage(void* object, SmallArray<pd::Atom>&& list);
     void sendDirectMessage(void* object, SmallString const& msg);
     void sendDirectMessage(void* object, float msg);
 
+    // Sends to a receiver name, in order with the direct messages
+    void sendQueuedMessage(SmallString const& receiver, SmallString const& msg, SmallArray<Atom>&& list);
+
+    // Sends the message right away, after everything that is still queued. You need to hold the audio lock
+    // For callers that change the object or read from it around the message
+    void sendDirectMessageNow(void* object, SmallString const& msg, SmallArray<Atom>&& list);
+
+    void sendDirectMessagesFromQueue();
+
     void updateObjectImplementations();
     void clearObjectImplementationsForPatch(pd::Patch* p);
 
@@ -275,6 +378,9 @@ public:
 
     virtual void performLatencyCompensationChange(float value) = 0;
 
+    virtual void setPlayheadInterpolation(bool interpolate) = 0;
+    virtual void requestPlayheadRefresh() = 0;
+
     // JYG added this
     virtual void fillDataBuffer(SmallArray<pd::Atom> const& list) = 0;
     virtual void parseDataBuffer(XmlElement const& xml) = 0;
@@ -287,7 +393,7 @@ public:
     std::deque<std::tuple<void*, String, int, int, int>>& getConsoleHistory();
 
     void sendMessagesFromQueue();
-    void processSend(dmessage mess);
+    void processSend(dmessage const& mess);
 
     Patch::Ptr openPatch(File const& toOpen);
 
@@ -307,6 +413,7 @@ public:
     void* messageReceiver = nullptr;
     void* parameterReceiver = nullptr;
     void* pluginLatencyReceiver = nullptr;
+    void* playheadReceiver = nullptr;
     void* parameterChangeReceiver = nullptr;
     void* parameterCreateReceiver = nullptr;
     void* parameterDestroyReceiver = nullptr;
@@ -321,19 +428,23 @@ public:
     bool initialiseIntoPluginmode = false;
     bool isPerformingGlobalSync = false;
     CriticalSection const audioLock;
-    CriticalSection const weakReferenceLock;
     std::unique_ptr<pd::MessageDispatcher> messageDispatcher;
+    pd::Profiler profiler;
 
     // All opened patches
     SmallArray<pd::Patch::Ptr, 16> patches;
 
 
 private:
-    UnorderedMap<void*, SmallArray<pd_weak_reference*>> pdWeakReferences;
+    WeakReferenceRegistry weakReferences;
 
     moodycamel::ConcurrentQueue<std::function<void(void)>> functionQueue = moodycamel::ConcurrentQueue<std::function<void(void)>>(4096);
     moodycamel::ConcurrentQueue<Message> guiMessageQueue = moodycamel::ConcurrentQueue<Message>(64);
 
+    void enqueueDirectMessage(WeakReference const& object, SmallString const& destination, SmallString const& selector, SmallArray<pd::Atom>&& list);
+
+    DirectMessageQueue directMessageQueue;
+
     std::unique_ptr<FileChooser> openChooser;
     static inline UnorderedSet<hash32> luaClasses = UnorderedSet<hash32>(); // Keep track of class names that correspond to pdlua objects
 
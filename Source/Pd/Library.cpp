@@ -45,6 +45,22 @@ Library::Library(pd::Instance* instance)
     watcher.addFolder(ProjectInfo::appDataDir);
     watcher.addListener(this);
 
+    helpDirectoryListener.onChange = [this]() {
+        helpFileCache.clear();
+    };
+    helpDirectoryWatcher.addListener(&helpDirectoryListener);
+
+    StringArray helpPathNames;
+    for (auto const& path : helpPaths) {
+        helpPathNames.add(path.getFullPathName());
+    }
+    libraryIndex.setHelpPaths(helpPathNames);
+
+    libraryIndex.onChange = [this]() {
+        helpFileCache.clear();
+        updateAllObjects();
+    };
+
     // Needs to be async, otherwise LV2 validation fails
     MessageManager::callAsync([this, pd = juce::WeakReference(pd)]() {
         if (pd.get()) {
@@ -67,6 +83,18 @@ void Library::updateLibrary()
     auto settingsTree = ValueTree::fromXml(ProjectInfo::appDataDir.getChildFile(".settings").loadFileAsString());
     auto pathTree = settingsTree.getChildWithName("Paths");
 
+    // Patches in our search tree are found by the library index, on a background thread
+    StringArray searchPaths;
+    for (auto path : pathTree) {
+        auto file = File(path.getProperty("Path").toString());
+        if (!file.isDirectory())
+            continue;
+
+        searchPaths.add(file.getFullPathName());
+        watcher.addFolder(file);
+    }
+    libraryIndex.setSearchPaths(searchPaths);
+
     pd->lockAudioThread();
     pd->setThis();
 
@@ -76,7 +104,7 @@ void Library::updateLibrary()
     auto* mlist = static_cast<t_methodentry*>(libpd_get_class_methods(o));
     t_methodentry* m;
 
-    allObjects.clear();
+    pdObjects.clear();
 
     int i;
     for (i = o->c_nmethod, m = mlist; i--; m++) {
@@ -85,27 +113,19 @@ void Library::updateLibrary()
 
         auto newName = String::fromUTF8(m->me_name->s_name);
         if (!(newName.startsWith("else/") || newName.startsWith("cyclone/") || newName.endsWith("_aliased"))) {
-            allObjects.add(newName);
+            pdObjects.add(newName);
         }
     }
 
-    // Find patches in our search tree
-    for (auto path : pathTree) {
-        auto filePath = path.getProperty("Path").toString();
+    pd->unlockAudioThread();
 
-        auto file = File(filePath);
-        if (!file.exists() || !file.isDirectory())
-            continue;
+    updateAllObjects();
+}
 
-        for (auto const& file : OSUtils::iterateDirectory(file, false, true)) {
-            if (file.hasFileExtension("pd")) {
-                auto filename = file.getFileNameWithoutExtension();
-                if (!filename.startsWith("help-") && !filename.endsWith("-help")) {
-                    allObjects.add(filename);
-                }
-            }
-        }
-    }
+void Library::updateAllObjects()
+{
+    allObjects = pdObjects;
+    allObjects.addArray(libraryIndex.getAbstractionNames());
 
     // These can't be created by name in Pd, but plugdata allows it
     allObjects.add("graph");
@@ -115,8 +135,6 @@ void Library::updateLibrary()
     allObjects.add("float");
     allObjects.add("symbol");
     allObjects.add("list");
-
-    pd->unlockAudioThread();
 }
 
 void Library::run()
@@ -330,8 +348,18 @@ StringArray Library::getAllObjects()
     return allObjects;
 }
 
+void Library::fileChanged(File const file, FileSystemWatcher::FileSystemEvent event)
+{
+    if (file.isHidden() || file.getFileName().startsWith("."))
+        return;
+
+    libraryIndex.invalidate(file);
+    FileSystemWatcher::Listener::fileChanged(file, event);
+}
+
 void Library::filesystemChanged()
 {
+    helpFileCache.clear();
     updateLibrary();
 }
 
@@ -386,6 +414,7 @@ File Library::findHelpfile(t_gobj* obj, File const& parentPatchFile)
 {
     String helpName;
     String helpDir;
+    String abstractionDir;
 
     auto* pdclass = pd_class(reinterpret_cast<t_pd*>(obj));
 
@@ -399,20 +428,27 @@ File Library::findHelpfile(t_gobj* obj, File const& parentPatchFile)
 
         atom_string(av, namebuf, MAXPDSTRING);
         helpName = String::fromUTF8(namebuf);
+        abstractionDir = String::fromUTF8(canvas_getenv(reinterpret_cast<t_canvas*>(obj))->ce_dir->s_name);
     } else {
         helpDir = class_gethelpdir(pdclass);
         helpName = class_gethelpname(pdclass);
         helpName = helpName.upToLastOccurrenceOf(".pd", false, false);
     }
 
+    auto classHelpDir = String::fromUTF8(class_gethelpdir(pdclass));
+
+    // The result only depends on the class name, its help dir and the directories around the object
+    auto cacheKey = hash(helpName + "\n" + classHelpDir + "\n" + abstractionDir + "\n" + parentPatchFile.getFullPathName());
+    if (auto cached = helpFileCache.find(cacheKey); cached != helpFileCache.end())
+        return cached->second;
+
     auto patchHelpPaths = SmallArray<File, 16>();
 
     // Add abstraction dir to search paths
-    if (pdclass == canvas_class && canvas_isabstraction(reinterpret_cast<t_canvas*>(obj))) {
-        auto* cnv = reinterpret_cast<t_canvas*>(obj);
-        patchHelpPaths.add(File(String::fromUTF8(canvas_getenv(cnv)->ce_dir->s_name)));
+    if (abstractionDir.isNotEmpty()) {
+        patchHelpPaths.add(File(abstractionDir));
         if (helpDir.isNotEmpty()) {
-            patchHelpPaths.add(File(String::fromUTF8(canvas_getenv(cnv)->ce_dir->s_name)).getChildFile(helpDir));
+            patchHelpPaths.add(File(abstractionDir).getChildFile(helpDir));
         }
     }
 
@@ -428,18 +464,41 @@ File Library::findHelpfile(t_gobj* obj, File const& parentPatchFile)
         patchHelpPaths.add(helpDir.isNotEmpty() ? path.getChildFile(helpDir) : path);
     }
 
+    if (classHelpDir.isNotEmpty()) {
+        patchHelpPaths.add(File(classHelpDir));
+    }
+
     String firstName = helpName + "-help.pd";
     String secondName = "help-" + helpName + ".pd";
 
-    auto findHelpPatch = [&firstName, &secondName](File const& searchDir) -> File {
-        for (auto const& file : OSUtils::iterateDirectory(searchDir, false, true)) {
-            auto pathName = file.getFullPathName().replace("\\", "/").trimCharactersAtEnd("/");
-            // Hack to make it find else/cyclone/Gem helpfiles...
-            pathName = pathName.replace("/9.else", "/else");
-            pathName = pathName.replace("/10.cyclone", "/cyclone");
-            pathName = pathName.replace("/14.gem", "/Gem");
+    auto matchesHelpName = [&firstName, &secondName](File const& file) {
+        auto pathName = file.getFullPathName().replace("\\", "/").trimCharactersAtEnd("/");
+        // Hack to make it find else/cyclone/Gem helpfiles...
+        pathName = pathName.replace("/9.else", "/else");
+        pathName = pathName.replace("/10.cyclone", "/cyclone");
+        pathName = pathName.replace("/14.gem", "/Gem");
+
+        return pathName.endsWith("/" + firstName) || pathName.endsWith("/" + secondName);
+    };
+
+    auto findHelpPatch = [this, &firstName, &secondName, &matchesHelpName](File const& searchDir) -> File {
+        // Help paths are indexed in the background, so we only have to check files with the right name
+        if (libraryIndex.isIndexed(searchDir)) {
+            for (auto const& name : { firstName, secondName }) {
+                for (auto const& path : libraryIndex.getHelpFiles(name.fromLastOccurrenceOf("/", false, false))) {
+                    auto file = File(path);
+                    if (file.getParentDirectory() == searchDir && matchesHelpName(file))
+                        return file;
+                }
+            }
+            return {};
+        }
+
+        // Directories outside of the index are watched, so adding a help file to them clears the cache
+        helpDirectoryWatcher.addFolder(searchDir);
 
-            if (pathName.endsWith("/" + firstName) || pathName.endsWith("/" + secondName)) {
+        for (auto const& file : OSUtils::iterateDirectory(searchDir, false, true)) {
+            if (matchesHelpName(file)) {
                 return file;
             }
         }
@@ -453,21 +512,12 @@ File Library::findHelpfile(t_gobj* obj, File const& parentPatchFile)
 
         auto file = findHelpPatch(path);
         if (file.existsAsFile()) {
+            helpFileCache[cacheKey] = file;
             return file;
         }
     }
 
-    auto* rawHelpDir = class_gethelpdir(pd_class(&reinterpret_cast<t_gobj*>(obj)->g_pd));
-    helpDir = String::fromUTF8(rawHelpDir);
-
-    if (helpDir.isNotEmpty() && File(helpDir).exists()) {
-        // Search for files in the patch directory
-        auto file = findHelpPatch(helpDir);
-        if (file.existsAsFile()) {
-            return file;
-        }
-    }
-
+    helpFileCache[cacheKey] = File();
     return {};
 }
 
@@ -9,6 +9,7 @@
 #include <m_pd.h>
 #include "Utility/FileSystemWatcher.h"
 #include "Utility/Config.h"
+#include "LibraryIndex.h"
 
 #include <fuzzysearchdatabase/src/FuzzySearchDatabase.hpp>
 
@@ -39,9 +40,10 @@ public:
 
     static StackArray<StringArray, 2> parseIoletTooltips(ValueTree const& iolets, String const& name, int numIn, int numOut);
 
+    void fileChanged(File const file, FileSystemWatcher::FileSystemEvent event) override;
     void filesystemChanged() override;
 
-    static File findHelpfile(t_gobj* obj, File const& parentPatchFile);
+    File findHelpfile(t_gobj* obj, File const& parentPatchFile);
 
     ValueTree getObjectInfo(String const& name);
 
@@ -76,18 +78,33 @@ public:
     static inline StringArray objectOrigins = { "vanilla", "ELSE", "cyclone", "Gem", "heavylib", "pdlua" };
 
 private:
+    void updateAllObjects();
+
     StringArray allObjects;
+    StringArray pdObjects;
     StringArray gemObjects;
 
     std::recursive_mutex libraryLock;
 
     fuzzysearch::Database<ValueTree> searchDatabase;
 
+    // Clears the help file cache when something changes in a directory we searched for help files
+    struct HelpDirectoryListener : public FileSystemWatcher::Listener {
+        std::function<void()> onChange;
+        void filesystemChanged() override { onChange(); }
+    };
+
+    HelpDirectoryListener helpDirectoryListener;
+    FileSystemWatcher helpDirectoryWatcher;
     FileSystemWatcher watcher;
+    LibraryIndex libraryIndex;
     WaitableEvent initWait;
     pd::Instance* pd;
 
     UnorderedMap<hash32, ValueTree> documentationIndex;
+    // Help file lookups by class name and directory, found or not
+    // Cleared by the library index and the file watchers, so a hit never has to touch the disk
+    UnorderedMap<hash32, File> helpFileCache;
     bool isInitialised = false;
 };
 
@@ -0,0 +1,297 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen.
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include <juce_data_structures/juce_data_structures.h>
+#include <juce_events/juce_events.h>
+
+#include "Utility/Config.h"
+#include "Utility/OSUtils.h"
+
+#include "LibraryIndex.h"
+
+namespace pd {
+
+LibraryIndex::LibraryIndex()
+    : Thread("Library File Index Thread")
+{
+    startThread(Thread::Priority::low);
+}
+
+LibraryIndex::~LibraryIndex()
+{
+    cancelPendingUpdate();
+    signalThreadShouldExit();
+    notify();
+    stopThread(-1);
+}
+
+void LibraryIndex::setSearchPaths(StringArray const& paths)
+{
+    {
+        ScopedLock sl(lock);
+        if (searchPaths == paths)
+            return;
+
+        searchPaths = paths;
+    }
+
+    notify();
+}
+
+void LibraryIndex::setHelpPaths(StringArray const& paths)
+{
+    {
+        ScopedLock sl(lock);
+        if (helpPaths == paths)
+            return;
+
+        helpPaths = paths;
+    }
+
+    notify();
+}
+
+void LibraryIndex::invalidate(File const& changedFile)
+{
+    {
+        ScopedLock sl(lock);
+        dirtyDirectories.insert(changedFile.getParentDirectory().getFullPathName());
+        dirtyDirectories.insert(changedFile.getFullPathName());
+    }
+
+    notify();
+}
+
+StringArray LibraryIndex::getAbstractionNames() const
+{
+    ScopedLock sl(lock);
+    return abstractionNames;
+}
+
+bool LibraryIndex::isIndexed(File const& directory) const
+{
+    ScopedLock sl(lock);
+    for (auto const& path : completedHelpPaths) {
+        auto root = File(path);
+        if (directory == root || directory.isAChildOf(root))
+            return true;
+    }
+
+    return false;
+}
+
+StringArray LibraryIndex::getHelpFiles(String const& fileName) const
+{
+    ScopedLock sl(lock);
+    auto it = helpFiles.find(fileName);
+    if (it == helpFiles.end())
+        return {};
+
+    return it->second;
+}
+
+void LibraryIndex::run()
+{
+    loadFromDisk();
+    publish();
+
+    while (!threadShouldExit()) {
+        if (rescan()) {
+            publish();
+            saveToDisk();
+        }
+
+        wait(-1);
+    }
+}
+
+void LibraryIndex::handleAsyncUpdate()
+{
+    if (onChange)
+        onChange();
+}
+
+bool LibraryIndex::rescan()
+{
+    StringArray paths;
+    StringArray recursivePaths;
+    UnorderedSet<String> dirty;
+    {
+        ScopedLock sl(lock);
+        paths = searchPaths;
+        recursivePaths = helpPaths;
+        dirty.swap(dirtyDirectories);
+    }
+
+    UnorderedMap<String, Directory> result;
+    result.reserve(directories.size());
+
+    bool changed = false;
+    SmallArray<hash32> visited;
+
+    // Recursive paths go first, because directories are only visited once
+    for (auto const& path : recursivePaths) {
+        if (threadShouldExit())
+            return false;
+
+        if (OSUtils::isDirectoryFast(path))
+            scanDirectory(path, true, result, dirty, visited, changed);
+    }
+
+    for (auto const& path : paths) {
+        if (threadShouldExit())
+            return false;
+
+        if (OSUtils::isDirectoryFast(path))
+            scanDirectory(path, false, result, dirty, visited, changed);
+    }
+
+    // Don't replace the index with a partial scan
+    if (threadShouldExit())
+        return false;
+
+    // A directory was removed from the index, or the search paths changed
+    changed = changed || result.size() != directories.size() || paths != indexedSearchPaths || recursivePaths != indexedHelpPaths;
+
+    directories.swap(result);
+    indexedSearchPaths = paths;
+    indexedHelpPaths = recursivePaths;
+    return changed;
+}
+
+void LibraryIndex::scanDirectory(String const& path, bool recursive, UnorderedMap<String, Directory>& result, UnorderedSet<String> const& dirty, SmallArray<hash32>& visited, bool& changed)
+{
+    if (threadShouldExit() || result.contains(path))
+        return;
+
+    auto modificationTime = File(path).getLastModificationTime().toMilliseconds();
+
+    auto cached = directories.find(path);
+    auto& directory = result[path];
+    if (cached != directories.end() && cached->second.modificationTime == modificationTime && !dirty.contains(path)) {
+        directory = cached->second;
+    } else {
+        directory.modificationTime = modificationTime;
+        for (auto const& file : OSUtils::iterateDirectory(File(path), false, false)) {
+            auto fullPath = file.getFullPathName();
+            if (OSUtils::isDirectoryFast(fullPath)) {
+                directory.subdirectories.add(fullPath);
+            } else if (file.hasFileExtension("pd")) {
+                directory.patches.add(file.getFileNameWithoutExtension());
+            }
+        }
+
+        changed = changed || cached == directories.end() || cached->second.patches != directory.patches || cached->second.subdirectories != directory.subdirectories;
+    }
+
+    if (!recursive)
+        return;
+
+    // Protect against symlink loops
+    auto directoryHash = OSUtils::getUniqueFileHash(path);
+    if (visited.contains(directoryHash))
+        return;
+
+    // Copy, because the map can be rehashed while we recurse
+    auto subdirectories = directory.subdirectories;
+
+    visited.add(directoryHash);
+    for (auto const& subdirectory : subdirectories) {
+        scanDirectory(subdirectory, true, result, dirty, visited, changed);
+    }
+    visited.pop_back();
+}
+
+void LibraryIndex::publish()
+{
+    StringArray names;
+    UnorderedSet<String> addedNames;
+    for (auto const& path : indexedSearchPaths) {
+        auto it = directories.find(path);
+        if (it == directories.end())
+            continue;
+
+        for (auto const& name : it->second.patches) {
+            if (!isHelpFile(name) && addedNames.insert(name).second)
+                names.add(name);
+        }
+    }
+
+    UnorderedMap<String, StringArray> newHelpFiles;
+    for (auto& [path, directory] : directories) {
+        for (auto const& name : directory.patches) {
+            if (isHelpFile(name))
+                newHelpFiles[name + ".pd"].add(path + File::getSeparatorString() + name + ".pd");
+        }
+    }
+
+    // Make the result independent of hash map order
+    for (auto& [name, paths] : newHelpFiles) {
+        paths.sort(false);
+    }
+
+    {
+        ScopedLock sl(lock);
+        abstractionNames.swapWith(names);
+        helpFiles.swap(newHelpFiles);
+        completedHelpPaths = indexedHelpPaths;
+    }
+
+    triggerAsyncUpdate();
+}
+
+void LibraryIndex::loadFromDisk()
+{
+    FileInputStream stream(indexFile);
+    if (!stream.openedOk())
+        return;
+
+    auto tree = ValueTree::readFromStream(stream);
+    if (!tree.isValid() || static_cast<int>(tree.getProperty("Version")) != indexVersion)
+        return;
+
+    indexedSearchPaths.addTokens(tree.getProperty("SearchPaths").toString(), "\n", "");
+    indexedSearchPaths.removeEmptyStrings();
+    indexedHelpPaths.addTokens(tree.getProperty("HelpPaths").toString(), "\n", "");
+    indexedHelpPaths.removeEmptyStrings();
+
+    for (auto child : tree) {
+        Directory directory;
+        directory.modificationTime = static_cast<int64>(child.getProperty("Time"));
+        directory.patches.addTokens(child.getProperty("Patches").toString(), "\n", "");
+        directory.subdirectories.addTokens(child.getProperty("Subdirectories").toString(), "\n", "");
+        directory.patches.removeEmptyStrings();
+        directory.subdirectories.removeEmptyStrings();
+        directories[child.getProperty("Path").toString()] = directory;
+    }
+}
+
+void LibraryIndex::saveToDisk()
+{
+    ValueTree tree("LibraryIndex");
+    tree.setProperty("Version", indexVersion, nullptr);
+    tree.setProperty("SearchPaths", indexedSearchPaths.joinIntoString("\n"), nullptr);
+    tree.setProperty("HelpPaths", indexedHelpPaths.joinIntoString("\n"), nullptr);
+
+    for (auto& [path, directory] : directories) {
+        ValueTree child("Directory");
+        child.setProperty("Path", path, nullptr);
+        child.setProperty("Time", directory.modificationTime, nullptr);
+        child.setProperty("Patches", directory.patches.joinIntoString("\n"), nullptr);
+        child.setProperty("Subdirectories", directory.subdirectories.joinIntoString("\n"), nullptr);
+        tree.appendChild(child, nullptr);
+    }
+
+    // Write to a temporary file first, so we never leave a half written index behind
+    TemporaryFile tempFile(indexFile);
+    if (auto stream = tempFile.getFile().createOutputStream()) {
+        tree.writeToStream(*stream);
+        stream.reset();
+        tempFile.overwriteTargetFileWithTemporary();
+    }
+}
+
+} // namespace pd
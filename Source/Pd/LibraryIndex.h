@@ -0,0 +1,86 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen.
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include "Utility/Containers.h"
+#include "Utility/Hash.h"
+
+namespace pd {
+
+// Index of the patches inside the search paths and help paths, built on a background thread
+// Directories are only listed again when their modification time changes, so after the first scan an update only needs
+// to check the modification time of every directory. The index is stored in the app data dir, so it's immediately
+// available on the next launch
+class LibraryIndex : private Thread
+    , private AsyncUpdater {
+public:
+    LibraryIndex();
+    ~LibraryIndex() override;
+
+    // Starts a rescan if the paths changed
+    void setSearchPaths(StringArray const& paths);
+
+    // Help paths are indexed recursively, including all subdirectories
+    void setHelpPaths(StringArray const& paths);
+
+    // Marks the directory that a file is in as changed, and rescans
+    void invalidate(File const& changedFile);
+
+    // Names of all patches directly inside the search paths, without help files
+    // Like Pd, we don't look into subdirectories of search paths for abstractions
+    StringArray getAbstractionNames() const;
+
+    // Returns true if the directory and all its subdirectories are covered by the index
+    bool isIndexed(File const& directory) const;
+
+    // Full paths of all indexed help files with this file name
+    StringArray getHelpFiles(String const& fileName) const;
+
+    // Called on the message thread when the contents of the index changed
+    std::function<void()> onChange = nullptr;
+
+private:
+    struct Directory {
+        int64 modificationTime = 0;
+        StringArray patches; // Without extension
+        StringArray subdirectories;
+    };
+
+    void run() override;
+    void handleAsyncUpdate() override;
+
+    bool rescan();
+    void scanDirectory(String const& path, bool recursive, UnorderedMap<String, Directory>& result, UnorderedSet<String> const& dirty, SmallArray<hash32>& visited, bool& changed);
+    void publish();
+
+    void loadFromDisk();
+    void saveToDisk();
+
+    static bool isHelpFile(String const& name)
+    {
+        return name.startsWith("help-") || name.endsWith("-help");
+    }
+
+    // Only accessed by the index thread
+    UnorderedMap<String, Directory> directories;
+    StringArray indexedSearchPaths;
+    StringArray indexedHelpPaths;
+
+    // Shared between threads
+    CriticalSection const lock;
+    StringArray searchPaths;
+    StringArray helpPaths;
+    UnorderedSet<String> dirtyDirectories;
+    StringArray abstractionNames;
+    StringArray completedHelpPaths;
+    UnorderedMap<String, StringArray> helpFiles; // File name -> full paths
+
+    static inline File const indexFile = ProjectInfo::appDataDir.getChildFile(".library_index");
+    static constexpr int indexVersion = 2;
+};
+
+} // namespace pd
@@ -7,7 +7,6 @@
 
 #include "Instance.h"
 #include <readerwriterqueue.h>
-#include "Utility/Stack.h"
 
 namespace pd {
 
@@ -24,48 +23,99 @@ public:
 // without performing and memory allocation or locking
 class MessageDispatcher {
 
-    // Represents a single Pd message.
-    // Holds target object, and symbol+size compressed into a single value
-    // Atoms are stored in a separate buffer, and read out based on reported size
+    // Represents the newest Pd message for a target and selector
+    // Atoms are stored in a separate arena, and read out based on offset and size
     struct Message {
-        PointerIntPair<void*, 2, uint8_t> targetAndSize;
-        PointerIntPair<t_symbol*, 2, uint8_t> symbolAndSize;
+        void* target;
+        t_symbol* symbol;
+        uint32_t atomOffset;
+        uint32_t numAtoms;
+        uint32_t atomCapacity;
+        uint32_t indexSlot;
     };
-    
-    static constexpr int StackSize = 1 << 20;
-    using MessageStack = plf::stack<Message>;
-    using AtomStack = plf::stack<t_atom>;
 
-    struct MessageBuffer
-    {
-        MessageStack messages;
-        AtomStack atoms;
+    static constexpr uint32_t MaxMessages = 1 << 16;
+    static constexpr uint32_t MaxAtoms = 1 << 18;
+    static constexpr uint32_t IndexSize = MaxMessages << 1;
+
+    // Flat arena of messages, with an open-addressed index from target+selector to the message that holds its latest value
+    // When a target receives the same message multiple times within a frame, we only keep the last one
+    // Everything is allocated up front, so the audio thread never touches the heap
+    struct MessageBuffer {
+        MessageBuffer()
+            : messages(MaxMessages)
+            , atoms(MaxAtoms)
+            , index(IndexSize, 0)
+        {
+        }
+
+        void push(void* target, t_symbol* symbol, int argc, t_atom* argv) noexcept
+        {
+            auto const size = static_cast<uint32_t>(std::max(argc, 0));
+            auto slot = getIndexSlot(target, symbol);
+
+            while (auto const entry = index[slot]) {
+                auto& message = messages[entry - 1];
+                if (message.target == target && message.symbol == symbol) {
+                    // Overwrite the previous value in-place if it fits, otherwise move it to the end of the arena
+                    if (size > message.atomCapacity) {
+                        if (EXPECT_UNLIKELY(numAtoms + size > MaxAtoms))
+                            return;
+                        message.atomOffset = numAtoms;
+                        message.atomCapacity = size;
+                        numAtoms += size;
+                    }
+                    std::copy_n(argv, size, atoms.data() + message.atomOffset);
+                    message.numAtoms = size;
+                    return;
+                }
+                slot = (slot + 1) & (IndexSize - 1);
+            }
+
+            if (EXPECT_UNLIKELY(numMessages == MaxMessages || numAtoms + size > MaxAtoms))
+                return;
+
+            index[slot] = numMessages + 1;
+            messages[numMessages++] = { target, symbol, numAtoms, size, size, slot };
+            std::copy_n(argv, size, atoms.data() + numAtoms);
+            numAtoms += size;
+        }
+
+        // Only resets the index slots that were used, so this is O(number of unique messages)
+        void clear() noexcept
+        {
+            for (uint32_t i = 0; i < numMessages; i++) {
+                index[messages[i].indexSlot] = 0;
+            }
+            numMessages = 0;
+            numAtoms = 0;
+        }
+
+        static uint32_t getIndexSlot(void* target, t_symbol* symbol) noexcept
+        {
+            auto key = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(target)) ^ (static_cast<uint64_t>(reinterpret_cast<uintptr_t>(symbol)) * 0x9E3779B97F4A7C15ull);
+            key ^= key >> 29;
+            key *= 0xBF58476D1CE4E5B9ull;
+            key ^= key >> 32;
+            return static_cast<uint32_t>(key) & (IndexSize - 1);
+        }
+
+        HeapArray<Message> messages;
+        HeapArray<t_atom> atoms;
+        HeapArray<uint32_t> index; // Message index + 1, or 0 for an empty slot
+        uint32_t numMessages = 0;
+        uint32_t numAtoms = 0;
     };
     
 public:
-    MessageDispatcher()
-    {
-        usedHashes.reserve(StackSize);
-        nullListeners.reserve(StackSize);
-        
-        for(auto& buffer : buffers)
-        {
-            buffer.messages.reserve(StackSize);
-            buffer.atoms.reserve(StackSize);
-        }
-    }
+    MessageDispatcher() = default;
 
     static void enqueueMessage(void* instance, void* target, t_symbol* symbol, int argc, t_atom* argv) noexcept
     {
         auto* pd = reinterpret_cast<pd::Instance*>(instance);
         auto* dispatcher = pd->messageDispatcher.get();
         if (ProjectInfo::isStandalone || EXPECT_LIKELY(!dispatcher->block)) {
-            auto size = std::min(argc, 15);
-            auto& backBuffer = dispatcher->getBackBuffer();
-            for (int i = 0; i < size; i++)
-                backBuffer.atoms.push(argv[i]);
-            
-            backBuffer.messages.push({ PointerIntPair<void*, 2, uint8_t>(target, (size >> 2) & 0b11), PointerIntPair<t_symbol*, 2, uint8_t>(symbol, size & 0b11) });
+            dispatcher->getBackBuffer().push(target, symbol, argc, argv);
         }
     }
 
@@ -79,8 +129,7 @@ public:
             sys_lock();
             for(auto& buffer : buffers)
             {
-                buffer.messages.clear();
-                buffer.atoms.clear();
+                buffer.clear();
             }
             sys_unlock();
         }
@@ -106,73 +155,40 @@ public:
             messageListeners.erase(object);
     }
 
-    bool popMessage(MessageStack& buffer, Message& result)
-    {
-        if (buffer.empty())
-            return false;
-
-        result = buffer.top();
-        buffer.pop();
-        return true;
-    }
-    
     void dequeueMessages() // Note: make sure correct pd instance is active when calling this
     {
         currentBuffer.store((currentBuffer.load() + 1) % 3);
         
         auto& frontBuffer = getFrontBuffer();
         
-        usedHashes.clear();
         nullListeners.clear();
 
-        Message message;
-        while (popMessage(frontBuffer.messages, message)) {
-            auto targetPtr = message.targetAndSize.getPointer();
-            auto target = messageListeners.find(targetPtr);
-            auto [symbol, size] = message.symbolAndSize;
-            size = (message.targetAndSize.getInt() << 2) | size;
-
-            if (EXPECT_LIKELY(target == messageListeners.end())) {
-                for (int at = 0; at < size; at++) {
-                    frontBuffer.atoms.pop();
-                }
-                continue;
-            }
+        for (uint32_t i = 0; i < frontBuffer.numMessages; i++) {
+            auto const& message = frontBuffer.messages[i];
+            auto target = messageListeners.find(message.target);
 
-            auto hash = reinterpret_cast<intptr_t>(message.targetAndSize.getOpaqueValue()) ^ reinterpret_cast<intptr_t>(message.symbolAndSize.getOpaqueValue());
-            if (EXPECT_UNLIKELY(usedHashes.contains(hash))) {
-                for (int at = 0; at < size; at++) {
-                    frontBuffer.atoms.pop();
-                }
+            if (EXPECT_LIKELY(target == messageListeners.end()) || !message.symbol)
                 continue;
-            }
-            usedHashes.insert(hash);
 
-            SmallArray<pd::Atom> atoms;
-            atoms.resize(size);
-            t_atom atom;
-
-            for (int at = size - 1; at >= 0; at--) {
-                atom = frontBuffer.atoms.top();
-                frontBuffer.atoms.pop();
-                atoms[at] = &atom;
+            atoms.resize(message.numAtoms);
+            for (uint32_t at = 0; at < message.numAtoms; at++) {
+                atoms[at] = frontBuffer.atoms.data() + message.atomOffset + at;
             }
 
-            if (!symbol)
-                continue;
-
             for (auto it = target->second.begin(); it != target->second.end(); ++it) {
                 if (it->wasObjectDeleted())
                     continue;
                 auto listener = it->get();
 
                 if (listener)
-                    listener->receiveMessage(symbol, atoms);
+                    listener->receiveMessage(message.symbol, atoms);
                 else
-                    nullListeners.add({ targetPtr, it });
+                    nullListeners.add({ message.target, it });
             }
         }
 
+        frontBuffer.clear();
+
         nullListeners.erase(
             std::remove_if(nullListeners.begin(), nullListeners.end(),
                 [&](auto const& entry) {
@@ -180,13 +196,6 @@ public:
                     return messageListeners[target].erase(iterator) != messageListeners[target].end();
                 }),
             nullListeners.end());
-        
-        // Make sure they don't grow excessively large
-        if(frontBuffer.messages.capacity() > StackSize*2)
-        {
-            frontBuffer.messages.trim();
-            frontBuffer.atoms.trim();
-        }
     }
     
     MessageBuffer& getBackBuffer()
@@ -205,7 +214,7 @@ private:
     AtomicValue<int> currentBuffer;
 
     SmallArray<std::pair<void*, UnorderedSet<juce::WeakReference<pd::MessageListener>>::iterator>, 16> nullListeners;
-    UnorderedSet<intptr_t> usedHashes;
+    SmallArray<pd::Atom> atoms; // Reused for every message, so we don't allocate while dequeueing
     UnorderedMap<void*, UnorderedSet<juce::WeakReference<MessageListener>>> messageListeners;
 };
 
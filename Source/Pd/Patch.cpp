@@ -12,11 +12,14 @@
 #include "Instance.h"
 #include "Interface.h"
 #include "Objects/ObjectBase.h"
+#include "Objects/AllGuis.h"
+#include "Utility/Hash.h"
 #include "../PluginEditor.h"
 
 extern "C" {
 #include <m_pd.h>
 #include <g_canvas.h>
+#include <g_all_guis.h>
 #include <m_imp.h>
 
 #include <utility>
@@ -230,6 +233,146 @@ HeapArray<pd::WeakReference> Patch::getObjects()
     return objects;
 }
 
+// Send and receive names of GUI objects, in the form the user typed them
+static void getSendReceiveSymbols(t_gobj* object, PatchSnapshot::Object& result)
+{
+    auto isValid = [](t_symbol const* s) {
+        return s != nullptr && s != gensym("");
+    };
+
+    switch (hash(result.className)) {
+    case hash("bng"):
+    case hash("hsl"):
+    case hash("vsl"):
+    case hash("slider"):
+    case hash("tgl"):
+    case hash("nbx"):
+    case hash("vradio"):
+    case hash("hradio"):
+    case hash("vu"):
+    case hash("cnv"): {
+        auto* iemgui = reinterpret_cast<t_iemgui*>(object);
+        t_symbol* srlsym[3];
+        iemgui_all_sym2dollararg(iemgui, srlsym);
+        if (isValid(srlsym[0]))
+            result.sendSymbol = iemgui->x_snd_unexpanded->s_name;
+        if (isValid(srlsym[1]))
+            result.receiveSymbol = iemgui->x_rcv_unexpanded->s_name;
+        break;
+    }
+    case hash("keyboard"): {
+        auto* keyboard = reinterpret_cast<t_fake_keyboard*>(object);
+        result.sendSymbol = keyboard->x_send->s_name;
+        result.receiveSymbol = keyboard->x_receive->s_name;
+        break;
+    }
+    case hash("pic"): {
+        auto* pic = reinterpret_cast<t_fake_pic*>(object);
+        result.sendSymbol = pic->x_send->s_name;
+        result.receiveSymbol = pic->x_receive->s_name;
+        break;
+    }
+    case hash("scope~"): {
+        result.receiveSymbol = reinterpret_cast<t_fake_scope*>(object)->x_receive->s_name;
+        break;
+    }
+    case hash("function"): {
+        auto* function = reinterpret_cast<t_fake_function*>(object);
+        result.sendSymbol = function->x_send->s_name;
+        result.receiveSymbol = function->x_receive->s_name;
+        break;
+    }
+    case hash("note"): {
+        result.receiveSymbol = reinterpret_cast<t_fake_note*>(object)->x_receive->s_name;
+        break;
+    }
+    case hash("knob"): {
+        auto* knob = reinterpret_cast<t_fake_knob*>(object);
+        result.sendSymbol = knob->x_snd->s_name;
+        result.receiveSymbol = knob->x_rcv->s_name;
+        break;
+    }
+    case hash("gatom"): {
+        auto* gatom = reinterpret_cast<t_fake_gatom*>(object);
+        result.atomType = gatom->a_flavor;
+        result.sendSymbol = gatom->a_symto->s_name;
+        result.receiveSymbol = gatom->a_symfrom->s_name;
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// Needs to be called while holding the Pd lock
+static void fillSnapshot(t_glist* patch, PatchSnapshot& snapshot, bool includeSubpatches)
+{
+    snapshot.isGraph = patch->gl_isgraph;
+    snapshot.isAbstraction = canvas_isabstraction(patch);
+
+    for (t_gobj* y = patch->gl_list; y; y = y->g_next) {
+        PatchSnapshot::Object object;
+        object.pointer = y;
+        object.className = pd::Interface::getObjectClassName(&y->g_pd);
+
+        int x, y1, w, h;
+        pd::Interface::getObjectBounds(patch, y, &x, &y1, &w, &h);
+        object.bounds = { x, y1, w, h };
+
+        if (auto* checked = pd::Interface::checkObject(y)) {
+            object.isPatchable = true;
+            object.numInlets = pd::Interface::numInlets(checked);
+            object.numOutlets = pd::Interface::numOutlets(checked);
+            object.textType = checked->te_type;
+
+            object.ioletOffset = static_cast<int>(snapshot.ioletSignals.size());
+            for (int i = 0; i < object.numInlets; i++)
+                snapshot.ioletSignals.add(pd::Interface::isSignalInlet(checked, i));
+            for (int i = 0; i < object.numOutlets; i++)
+                snapshot.ioletSignals.add(pd::Interface::isSignalOutlet(checked, i));
+
+            char* text;
+            int len;
+            pd::Interface::getObjectText(checked, &text, &len);
+            object.textOffset = static_cast<int>(snapshot.textArena.size());
+            object.textLength = len;
+            if (text) {
+                snapshot.textArena.insert(snapshot.textArena.end(), text, text + len);
+                freebytes(static_cast<void*>(text), static_cast<size_t>(len) * sizeof(char));
+            }
+        }
+
+        getSendReceiveSymbols(y, object);
+
+        if (pd_class(&y->g_pd) == canvas_class && includeSubpatches) {
+            object.subpatch = std::make_shared<PatchSnapshot>();
+            fillSnapshot(reinterpret_cast<t_glist*>(y), *object.subpatch, true);
+        } else if (hash(object.className) == hash("array")) {
+            snapshot.arrayNames.add(String::fromUTF8(reinterpret_cast<t_fake_garray*>(y)->x_name->s_name));
+        }
+
+        snapshot.objects.add(object);
+    }
+
+    t_linetraverser t;
+    linetraverser_start(&t, patch);
+    while (auto* oc = linetraverser_next_nosize(&t)) {
+        snapshot.connections.add({ oc, t.tr_ob, t.tr_outno, t.tr_ob2, t.tr_inno });
+    }
+}
+
+PatchSnapshot Patch::getSnapshot(bool includeSubpatches)
+{
+    setCurrent();
+
+    PatchSnapshot snapshot;
+    if (auto patch = ptr.get<t_glist>()) {
+        fillSnapshot(patch.get(), snapshot, includeSubpatches);
+    }
+
+    return snapshot;
+}
+
 t_gobj* Patch::createObject(int x, int y, String const& name)
 {
 
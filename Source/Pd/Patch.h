@@ -13,6 +13,61 @@ namespace pd {
 using Connections = HeapArray<std::tuple<t_outconnect*, int, t_object*, int, t_object*>>;
 class Instance;
 
+// Copy of the contents of a patch, taken while holding the Pd lock once
+// The GUI can read this without locking, instead of doing a locked lookup for every property of every object
+// Pointers are only for identifying objects, they may be dangling by the time the snapshot is read
+struct PatchSnapshot {
+    struct Object {
+        t_gobj* pointer;
+        char const* className; // Pd never frees symbols, so this is safe to read at any time
+        Rectangle<int> bounds;
+        int numInlets = 0;
+        int numOutlets = 0;
+        bool isPatchable = false; // False for scalars and other objects that aren't a t_object
+        int textOffset = 0;
+        int textLength = 0;
+        int ioletOffset = 0; // Into ioletSignals, inlets come first
+
+        // For the search panel, so it doesn't have to read from the objects
+        char const* sendSymbol = nullptr; // Unexpanded, as the user typed it
+        char const* receiveSymbol = nullptr;
+        int textType = 0; // te_type, tells comments apart from objects that failed to create
+        int atomType = 0; // a_flavor, only for gatoms
+        std::shared_ptr<PatchSnapshot> subpatch; // Only filled in when taken with subpatches
+    };
+
+    struct Connection {
+        t_outconnect* pointer;
+        t_object* outObject;
+        int outlet;
+        t_object* inObject;
+        int inlet;
+    };
+
+    String getText(Object const& object) const
+    {
+        if (object.textLength <= 0)
+            return {};
+
+        return String::fromUTF8(&textArena[object.textOffset], object.textLength);
+    }
+
+    // Signal flags of the inlets and then the outlets of an object
+    uint8 const* getIoletSignals(Object const& object) const
+    {
+        return object.numInlets + object.numOutlets > 0 ? &ioletSignals[object.ioletOffset] : nullptr;
+    }
+
+    HeapArray<Object> objects;
+    HeapArray<Connection> connections;
+    HeapArray<char> textArena;     // Text of all objects, stored back to back
+    HeapArray<uint8> ioletSignals; // Whether each iolet is a signal iolet, stored back to back
+
+    bool isGraph = false;
+    bool isAbstraction = false;
+    StringArray arrayNames; // Set if this is a graph that holds arrays
+};
+
 // The Pd patch.
 // Wrapper around a Pd patch. The lifetime of the internal patch
 // is not guaranteed by the class.
@@ -114,6 +169,10 @@ public:
     // Gets the objects of the patch.
     HeapArray<pd::WeakReference> getObjects();
 
+    // Copies objects and connections of the patch, with a single lock
+    // With includeSubpatches, the snapshot holds the contents of all subpatches too, still taken with a single lock
+    PatchSnapshot getSnapshot(bool includeSubpatches = false);
+
     String getCanvasContent();
 
     static void reloadPatch(File const& changedPatch, t_glist* except);
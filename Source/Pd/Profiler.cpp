@@ -0,0 +1,143 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include "Utility/Config.h"
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include "Profiler.h"
+
+extern "C" {
+#include <s_stuff.h>
+}
+
+pd::Profiler::Profiler()
+    : chainEntries(std::make_unique<ChainEntry[]>(maxChainEntries))
+{
+    lastTicks.resize(maxChainEntries, 0);
+}
+
+void pd::Profiler::addListener(Component* listener)
+{
+    if (listeners.add_unique(listener)) {
+        numListeners.store(listeners.size());
+        if (listeners.size() == 1) {
+            lastCollectTime = Time::getHighResolutionTicks();
+            startTimerHz(5);
+        }
+    }
+}
+
+void pd::Profiler::removeListener(Component* listener)
+{
+    if (listeners.remove_one(listener)) {
+        numListeners.store(listeners.size());
+        if (listeners.empty()) {
+            stopTimer();
+            objectLoads.clear();
+        }
+    }
+}
+
+bool pd::Profiler::isActive() const
+{
+    return numListeners.load() > 0 || installedChain != nullptr;
+}
+
+void pd::Profiler::prepareTick()
+{
+    auto* chain = STUFF->st_dspchain;
+    currentProfiler = this;
+
+    if (!chain) {
+        installedChain = nullptr;
+        return;
+    }
+
+    auto driver = reinterpret_cast<t_int>(&profiledChain);
+    if (numListeners.load() > 0) {
+        // Pd rebuilds the chain whenever the DSP graph changes, so we have to reinstall our driver
+        if (chain[0] != driver) {
+            originalRoutine = reinterpret_cast<t_perfroutine>(chain[0]);
+            chain[0] = driver;
+            installedChain = chain;
+        }
+    } else if (chain == installedChain && chain[0] == driver) {
+        chain[0] = reinterpret_cast<t_int>(originalRoutine);
+        installedChain = nullptr;
+    } else {
+        installedChain = nullptr;
+    }
+}
+
+t_int* pd::Profiler::profiledChain(t_int* w)
+{
+    auto* profiler = currentProfiler;
+    jassert(profiler);
+
+    auto* entries = profiler->chainEntries.get();
+    auto routine = profiler->originalRoutine;
+    auto lastTime = Time::getHighResolutionTicks();
+    int index = 0;
+
+    t_int* ip = w;
+    while (ip) {
+        auto* next = routine(ip);
+        auto now = Time::getHighResolutionTicks();
+
+        // The last routine in the chain (dsp_done) returns null and has no arguments
+        if (next && index < maxChainEntries) {
+            auto& entry = entries[index++];
+            entry.object.store(reinterpret_cast<void*>(ip[1]));
+            entry.ticks.store(entry.ticks.load() + (now - lastTime));
+        }
+
+        lastTime = now;
+        ip = next;
+        if (ip)
+            routine = reinterpret_cast<t_perfroutine>(*ip);
+    }
+
+    profiler->numChainEntries.store(index);
+    return nullptr;
+}
+
+float pd::Profiler::getLoad(void* object) const
+{
+    auto it = objectLoads.find(object);
+    if (it == objectLoads.end())
+        return 0.0f;
+
+    return it->second;
+}
+
+void pd::Profiler::timerCallback()
+{
+    auto now = Time::getHighResolutionTicks();
+    auto elapsed = static_cast<float>(now - lastCollectTime);
+    lastCollectTime = now;
+
+    if (elapsed <= 0.0f)
+        return;
+
+    objectLoads.clear();
+
+    // Ticks are accumulated per position in the chain, so a chain rebuild only misattributes a single interval
+    auto numEntries = numChainEntries.load();
+    for (int i = 0; i < numEntries; i++) {
+        auto& entry = chainEntries[i];
+        auto ticks = entry.ticks.load();
+        auto delta = ticks - lastTicks[i];
+        lastTicks[i] = ticks;
+
+        if (delta > 0) {
+            objectLoads[entry.object.load()] += static_cast<float>(delta) / elapsed;
+        }
+    }
+
+    for (auto* listener : listeners) {
+        listener->repaint();
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+extern "C" {
+#include <m_pd.h>
+}
+
+#include "Utility/Containers.h"
+
+namespace pd {
+
+// Measures how much time the perform routines in Pd's DSP chain take
+// While profiling, the first routine in the chain is replaced by a driver that walks the rest of the chain itself,
+// timestamping every perform call. Routines are attributed to the pointer in their first argument, which is the object
+// itself for nearly all externals and signal objects that carry state.
+class Profiler : public Timer {
+public:
+    static constexpr int maxChainEntries = 1 << 14;
+
+    Profiler();
+
+    // Profiling runs while at least one component is displaying the result
+    // These components get repainted whenever new measurements come in
+    void addListener(Component* listener);
+    void removeListener(Component* listener);
+
+    bool isActive() const;
+
+    // Called from the audio thread before Pd ticks, with the audio lock held and the pd instance set
+    // Installs the driver into a newly compiled DSP chain, or removes it when profiling is no longer needed
+    void prepareTick();
+
+    // Fraction of realtime that perform routines belonging to this object took during the last measurement interval
+    float getLoad(void* object) const;
+
+private:
+    void timerCallback() override;
+
+    static t_int* profiledChain(t_int* w);
+
+    struct ChainEntry {
+        AtomicValue<void*, Relaxed> object = nullptr;
+        AtomicValue<int64, Relaxed> ticks = 0;
+    };
+
+    // Written by the audio thread, read by the message thread
+    std::unique_ptr<ChainEntry[]> chainEntries;
+    AtomicValue<int, Relaxed> numChainEntries = 0;
+    AtomicValue<int, Relaxed> numListeners = 0;
+
+    // Only accessed by the audio thread
+    t_int* installedChain = nullptr;
+    t_perfroutine originalRoutine = nullptr;
+    static inline thread_local Profiler* currentProfiler = nullptr;
+
+    // Only accessed by the message thread
+    SmallArray<Component*> listeners;
+    HeapArray<int64> lastTicks;
+    int64 lastCollectTime = 0;
+    UnorderedMap<void*, float> objectLoads;
+};
+
+}
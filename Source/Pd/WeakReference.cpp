@@ -31,8 +31,10 @@ pd::WeakReference::WeakReference(WeakReference const& toCopy)
     : ptr(toCopy.ptr)
     , pd(toCopy.pd)
 {
-    weakRef = toCopy.weakRef.load();
+    // Register before reading the validity, so Pd can't free the object in between without us noticing
+    // This makes it safe to copy a reference without holding the audio lock
     pd->registerWeakReference(ptr, &weakRef);
+    weakRef = toCopy.weakRef.load();
 }
 
 pd::WeakReference::~WeakReference()
@@ -46,17 +48,15 @@ pd::WeakReference& pd::WeakReference::operator=(pd::WeakReference const& other)
     bool valid = other.ptr && other.pd;
     if (valid && this != &other) // Check for self-assignment
     {
-        pd = other.pd;
-
-        pd->weakReferenceLock.enter();
-        pd->unregisterWeakReference(ptr, &other.weakRef);
+        // Stop tracking the object we pointed to before
+        if (pd)
+            pd->unregisterWeakReference(ptr, &weakRef);
 
-        // Use atomic exchange to safely copy the weakRef value
-        weakRef.store(other.weakRef.load());
+        pd = other.pd;
         ptr = other.ptr;
 
         pd->registerWeakReference(ptr, &weakRef);
-        pd->weakReferenceLock.exit();
+        weakRef.store(other.weakRef.load());
     }
 
     return *this;
@@ -67,3 +67,64 @@ void pd::WeakReference::setThis() const
     if (pd)
         pd->setThis();
 }
+
+void pd::WeakReferenceRegistry::registerReference(void* ptr, pd_weak_reference* ref)
+{
+    auto& shard = getShard(ptr);
+    SpinLock::ScopedLockType lock(shard.lock);
+
+    auto& head = shard.heads[ptr];
+    ref->previous = nullptr;
+    ref->next = head;
+    if (head)
+        head->previous = ref;
+    head = ref;
+}
+
+void pd::WeakReferenceRegistry::unregisterReference(void* ptr, pd_weak_reference* ref)
+{
+    auto& shard = getShard(ptr);
+    SpinLock::ScopedLockType lock(shard.lock);
+
+    if (ref->previous) {
+        ref->previous->next = ref->next;
+        if (ref->next)
+            ref->next->previous = ref->previous;
+    } else {
+        // Without a previous reference, this is either the head of the list or it was already cleared
+        auto it = shard.heads.find(ptr);
+        if (it == shard.heads.end() || it->second != ref)
+            return;
+
+        if (ref->next) {
+            ref->next->previous = nullptr;
+            it->second = ref->next;
+        } else {
+            shard.heads.erase(it);
+        }
+    }
+
+    ref->previous = nullptr;
+    ref->next = nullptr;
+}
+
+void pd::WeakReferenceRegistry::clearReferences(void* ptr)
+{
+    auto& shard = getShard(ptr);
+    SpinLock::ScopedLockType lock(shard.lock);
+
+    auto it = shard.heads.find(ptr);
+    if (it == shard.heads.end())
+        return;
+
+    auto* ref = it->second;
+    while (ref) {
+        auto* next = ref->next;
+        ref->store(false);
+        ref->previous = nullptr;
+        ref->next = nullptr;
+        ref = next;
+    }
+
+    shard.heads.erase(it);
+}
@@ -11,11 +11,67 @@
 
 #include "Utility/Containers.h"
 
-using pd_weak_reference = std::atomic<bool>;
+// Validity flag of a weak reference, which is cleared when Pd frees the object
+// Also links the flag into the list of references to the same object, so unregistering doesn't need to search
+struct pd_weak_reference {
+    pd_weak_reference(bool isValid = true)
+        : valid(isValid)
+    {
+    }
+
+    bool load() const { return valid.load(); }
+    void store(bool isValid) { valid.store(isValid); }
+
+    operator bool() const { return valid.load(); }
+
+    pd_weak_reference& operator=(bool isValid)
+    {
+        valid.store(isValid);
+        return *this;
+    }
+
+    std::atomic<bool> valid;
+
+    // Only accessed by the registry, while holding the lock of the shard this reference is in
+    pd_weak_reference* previous = nullptr;
+    pd_weak_reference* next = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE(pd_weak_reference)
+};
 
 namespace pd {
 
 class Instance;
+
+// Keeps track of all weak references to Pd objects, so they can be invalidated when Pd frees an object
+// References to the same object form an intrusive linked list, so registering and unregistering is O(1)
+// The registry is split into shards with their own lock, so the GUI creating or destroying many references
+// rarely contends with the audio thread freeing objects
+class WeakReferenceRegistry {
+public:
+    static constexpr int numShards = 16;
+
+    void registerReference(void* ptr, pd_weak_reference* ref);
+    void unregisterReference(void* ptr, pd_weak_reference* ref);
+
+    // Called from the audio thread when Pd frees an object. Doesn't allocate
+    void clearReferences(void* ptr);
+
+private:
+    struct Shard {
+        SpinLock lock;
+        UnorderedMap<void*, pd_weak_reference*> heads;
+    };
+
+    Shard& getShard(void* ptr)
+    {
+        // Pd objects are at least 8 byte aligned, so skip the low bits
+        auto hash = reinterpret_cast<uintptr_t>(ptr) >> 4;
+        return shards[(hash ^ (hash >> 8)) % numShards];
+    }
+
+    Shard shards[numShards];
+};
 struct WeakReference {
     WeakReference(void* p, Instance* instance);
 
@@ -1610,9 +1610,7 @@ bool PluginEditor::perform(InvocationInfo const& info)
         cnv = getCurrentCanvas();
         cnv->patch.startUndoSequence("ConnectionPathFind");
 
-        for (auto* con : cnv->getSelectionOfType<Connection>()) {
-            con->applyBestPath();
-        }
+        Connection::applyBestPaths(cnv, cnv->getSelectionOfType<Connection>());
 
         cnv->patch.endUndoSequence("ConnectionPathFind");
         return true;
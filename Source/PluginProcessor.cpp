@@ -4,6 +4,7 @@
  // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
  */
 #include <clocale>
+#include <bit>
 #include <memory>
 
 #include <juce_gui_basics/juce_gui_basics.h>
@@ -137,6 +138,9 @@ PluginProcessor::PluginProcessor()
 
     // Set up midi buffers
     midiBufferInternalSynth.ensureSize(2048);
+    scheduledHostMidi.ensureSize(2048);
+    scheduledHostMidiSwap.ensureSize(2048);
+    hostMidiBlock.ensureSize(2048);
 
     atoms_playhead.reserve(3);
     atoms_playhead.resize(1);
@@ -156,6 +160,7 @@ PluginProcessor::PluginProcessor()
     settingsFile->saveSettings();
 
     oversampling = settingsFile->getProperty<int>("oversampling");
+    oversamplingQuality = settingsFile->getProperty<int>("oversampling_quality");
 
     setProtectedMode(settingsFile->getProperty<int>("protected"));
     setLimiterThreshold(settingsFile->getProperty<int>("limiter_threshold"));
@@ -189,6 +194,11 @@ void PluginProcessor::flushMessageQueue()
 {
     setThis();
     messageDispatcher->dequeueMessages();
+
+    // If the audio callback isn't running, nobody else is going to send our direct messages
+    if (Time::getMillisecondCounter() - lastAudioCallbackTime > 100) {
+        sendDirectMessagesFromQueue();
+    }
 }
 
 void PluginProcessor::initialiseFilesystem()
@@ -458,10 +468,28 @@ void PluginProcessor::setOversampling(int amount)
     suspendProcessing(false);
 }
 
+void PluginProcessor::setOversamplingQuality(int quality)
+{
+    quality = std::clamp(quality, static_cast<int>(OversamplingDraft), static_cast<int>(OversamplingLinearPhase));
+    if (oversamplingQuality == quality)
+        return;
+
+    settingsFile->setProperty("oversampling_quality", var(quality));
+
+    oversamplingQuality = quality;
+    auto blockSize = AudioProcessor::getBlockSize();
+    auto sampleRate = AudioProcessor::getSampleRate();
+
+    suspendProcessing(true);
+    prepareToPlay(sampleRate, blockSize);
+    suspendProcessing(false);
+}
+
 void PluginProcessor::setLimiterThreshold(int amount)
 {
     auto threshold = (StackArray<float, 4> { -12.f, -6.f, 0.f, 3.f })[amount];
-    limiter.setThreshold(threshold);
+    floatProcessing.limiter.setThreshold(threshold);
+    doubleProcessing.limiter.setThreshold(threshold);
 
     settingsFile->setProperty("limiter_threshold", var(amount));
 }
@@ -469,6 +497,9 @@ void PluginProcessor::setLimiterThreshold(int amount)
 void PluginProcessor::setProtectedMode(bool enabled)
 {
     protectedMode = enabled;
+
+    // The limiter delays the output to look ahead, so the host needs to know if it's on
+    updateLatency();
 }
 
 void PluginProcessor::numChannelsChanged()
@@ -481,6 +512,66 @@ void PluginProcessor::numChannelsChanged()
     suspendProcessing(false);
 }
 
+template<typename SampleType>
+PluginProcessor::AudioProcessingState<SampleType>& PluginProcessor::getProcessingState()
+{
+    if constexpr (std::is_same_v<SampleType, double>)
+        return doubleProcessing;
+    else
+        return floatProcessing;
+}
+
+template<typename SampleType>
+static std::unique_ptr<dsp::Oversampling<SampleType>> createOversampler(int numChannels, int factor, int quality)
+{
+    using Oversampling = dsp::Oversampling<SampleType>;
+
+    switch (quality) {
+    case PluginProcessor::OversamplingDraft: {
+        // Wider transition bands and less stopband rejection than JUCE's presets, so each stage needs fewer allpass sections
+        auto oversampler = std::make_unique<Oversampling>(numChannels);
+        if (factor == 0)
+            oversampler->addDummyOversamplingStage();
+
+        for (int stage = 0; stage < factor; stage++) {
+            // Later stages only need to reject images far above the audible band
+            auto const transitionWidth = stage == 0 ? 0.12f : 0.3f;
+            oversampler->addOversamplingStage(Oversampling::filterHalfBandPolyphaseIIR, transitionWidth, -50.0f, transitionWidth, -45.0f);
+        }
+
+        // The presets below get this from their constructor, it needs to be set before initProcessing
+        oversampler->setUsingIntegerLatency(true);
+        return oversampler;
+    }
+    case PluginProcessor::OversamplingLinearPhase:
+        return std::make_unique<Oversampling>(numChannels, factor, Oversampling::filterHalfBandFIREquiripple, true, true);
+    default:
+        // Polyphase allpass IIR: minimum phase, little latency, and what we have always used
+        return std::make_unique<Oversampling>(numChannels, factor, Oversampling::filterHalfBandPolyphaseIIR, false, true);
+    }
+}
+
+template<typename SampleType>
+void PluginProcessor::prepareProcessingState(AudioProcessingState<SampleType>& state, double sampleRate, int samplesPerBlock, int maxChannels)
+{
+    auto const pdBlockSize = Instance::getBlockSize();
+
+    state.oversampler = createOversampler<SampleType>(std::max(1, maxChannels), oversampling, oversamplingQuality);
+    state.oversampler->initProcessing(samplesPerBlock);
+
+    // Integer latency is enabled for every filter design, so this is exact and the host can compensate for it
+    oversamplerLatencySamples = oversampling > 0 ? static_cast<int>(std::round(state.oversampler->getLatencyInSamples())) : 0;
+
+    if (variableBlockSize) {
+        state.inputFifo = std::make_unique<AudioFifo<SampleType>>(maxChannels, std::max<int>(pdBlockSize, samplesPerBlock) * 3);
+        state.outputFifo = std::make_unique<AudioFifo<SampleType>>(maxChannels, std::max<int>(pdBlockSize, samplesPerBlock) * 3);
+        state.outputFifo->writeSilence(pdBlockSize);
+    }
+
+    state.limiter.prepare({ sampleRate, static_cast<uint32>(samplesPerBlock), std::max(1u, static_cast<uint32>(maxChannels)) });
+    limiterLatencySamples = state.limiter.getLatencyInSamples();
+}
+
 void PluginProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
     if (approximatelyEqual(sampleRate, 0.0))
@@ -491,31 +582,22 @@ void PluginProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 
     prepareDSP(getTotalNumInputChannels(), getTotalNumOutputChannels(), sampleRate * oversampleFactor, samplesPerBlock * oversampleFactor);
 
-    oversampler = std::make_unique<dsp::Oversampling<float>>(std::max(1, maxChannels), oversampling, dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, false);
-
-    oversampler->initProcessing(samplesPerBlock);
-
     if (internalSynthPort >= 0 && ProjectInfo::isStandalone) {
         internalSynth->prepare(sampleRate, samplesPerBlock, maxChannels);
     }
 
     audioAdvancement = 0;
-    auto const pdBlockSize = static_cast<size_t>(Instance::getBlockSize());
-    audioBufferIn.setSize(maxChannels, pdBlockSize);
-    audioBufferOut.setSize(maxChannels, pdBlockSize);
-
-    audioVectorIn.resize(maxChannels * pdBlockSize, 0.0f);
-    audioVectorOut.resize(maxChannels * pdBlockSize, 0.0f);
+    auto const pdBlockSize = Instance::getBlockSize();
 
     // If the block size is a multiple of 64 and we are not a plugin, we can optimise the process loop
     // Audio plugins can choose to send in a smaller block size when automation is happening
     variableBlockSize = !ProjectInfo::isStandalone || samplesPerBlock < pdBlockSize || samplesPerBlock % pdBlockSize != 0;
 
-    if (variableBlockSize) {
-        inputFifo = std::make_unique<AudioFifo>(maxChannels, std::max<int>(pdBlockSize, samplesPerBlock) * 3);
-        outputFifo = std::make_unique<AudioFifo>(maxChannels, std::max<int>(pdBlockSize, samplesPerBlock) * 3);
-        outputFifo->writeSilence(Instance::getBlockSize());
-    }
+    // The host sets the processing precision before calling prepareToPlay
+    if (isUsingDoublePrecision())
+        prepareProcessingState(doubleProcessing, sampleRate, samplesPerBlock, maxChannels);
+    else
+        prepareProcessingState(floatProcessing, sampleRate, samplesPerBlock, maxChannels);
 
     midiByteIndex = 0;
     midiByteBuffer[0] = 0;
@@ -536,9 +618,20 @@ void PluginProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
     statusbarSource->setBufferSize(samplesPerBlock);
     statusbarSource->prepareToPlay(getTotalNumOutputChannels());
 
-    limiter.prepare({ sampleRate, static_cast<uint32>(samplesPerBlock), std::max(1u, static_cast<uint32>(maxChannels)) });
-
     smoothedGain.reset(AudioProcessor::getSampleRate(), 0.02);
+
+    patchSwapGain.reset(AudioProcessor::getSampleRate(), 0.01);
+    patchSwapGain.setCurrentAndTargetValue(patchSwapState == PatchSwapIdle ? 1.0f : 0.0f);
+
+    updateLatency();
+}
+
+void PluginProcessor::updateLatency()
+{
+    // The fifo that adapts the host block size to Pd's block size delays by one Pd block, which is shorter in host samples when oversampling
+    auto const fifoLatency = Instance::getBlockSize() >> oversampling;
+    auto const limiterLatency = protectedMode ? limiterLatencySamples.load() : 0;
+    setLatencySamples(customLatencySamples + fifoLatency + oversamplerLatencySamples + limiterLatency);
 }
 
 void PluginProcessor::releaseResources()
@@ -599,28 +692,146 @@ void PluginProcessor::settingsFileReloaded()
 }
 
 
+bool PluginProcessor::supportsDoublePrecisionProcessing() const
+{
+    return PD_FLOATSIZE == 64;
+}
+
 void PluginProcessor::processBlockBypassed(AudioBuffer<float>& buffer, MidiBuffer& midiBuffer)
 {
+    processSamplesBypassed(buffer, midiBuffer);
+}
+
+void PluginProcessor::processBlockBypassed(AudioBuffer<double>& buffer, MidiBuffer& midiBuffer)
+{
+    processSamplesBypassed(buffer, midiBuffer);
+}
+
+void PluginProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiBuffer)
+{
+    processSamples(buffer, midiBuffer);
+}
+
+void PluginProcessor::processBlock(AudioBuffer<double>& buffer, MidiBuffer& midiBuffer)
+{
+    processSamples(buffer, midiBuffer);
+}
+
+template<typename SampleType>
+void PluginProcessor::processSamplesBypassed(AudioBuffer<SampleType>& buffer, MidiBuffer& midiBuffer)
+{
+    auto& bypassBuffer = getProcessingState<SampleType>().bypassBuffer;
     bypassBuffer.makeCopyOf(buffer);
 
     // It's better to keep sending blocks into Pd, so messaging can still work and there are no gaps in the users' audio stream
-    processBlock(bypassBuffer, midiBuffer);
+    processSamples(bypassBuffer, midiBuffer);
 
     for (int ch = 0; ch < getTotalNumOutputChannels(); ch++)
         buffer.clear(ch, 0, buffer.getNumSamples());
 }
 
-void PluginProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiBuffer)
+template<typename SampleType>
+static void applySmoothedGain(SmoothedValue<float, ValueSmoothingTypes::Linear>& smoothedValue, AudioBuffer<SampleType>& buffer)
 {
+    if constexpr (std::is_same_v<SampleType, float>) {
+        smoothedValue.applyGain(buffer, buffer.getNumSamples());
+    } else if (smoothedValue.isSmoothing()) {
+        // SmoothedValue can only apply gain to buffers of its own type
+        for (int i = 0; i < buffer.getNumSamples(); i++) {
+            auto const gain = static_cast<SampleType>(smoothedValue.getNextValue());
+            for (int ch = 0; ch < buffer.getNumChannels(); ch++)
+                buffer.getWritePointer(ch)[i] *= gain;
+        }
+    } else {
+        buffer.applyGain(static_cast<SampleType>(smoothedValue.getTargetValue()));
+    }
+}
+
+template<typename SampleType>
+void PluginProcessor::applyPatchSwapFade(AudioBuffer<SampleType>& buffer)
+{
+    auto swapState = patchSwapState.load();
+    patchSwapGain.setTargetValue(swapState == PatchSwapFadingOut ? 0.0f : 1.0f);
+    applySmoothedGain(patchSwapGain, buffer);
+
+    if (patchSwapGain.isSmoothing())
+        return;
+
+    // The message thread might have given up waiting and gone back to idle, so only advance from the state we faded for
+    if (swapState == PatchSwapFadingOut)
+        patchSwapState.compare_exchange_weak(swapState, PatchSwapSilent);
+    else if (swapState == PatchSwapFadingIn)
+        patchSwapState.compare_exchange_weak(swapState, PatchSwapIdle);
+}
+
+bool PluginProcessor::fadeOutForPatchSwap()
+{
+    // If the audio callback isn't running, nothing will fade out, and nobody will hear the swap
+    if (Time::getMillisecondCounter() - lastAudioCallbackTime > 100 || isNonRealtime())
+        return false;
+
+    // Some hosts load the state from the audio thread, which would be waiting for itself
+    if (Thread::getCurrentThreadId() == audioThreadId.load())
+        return false;
+
+    patchSwapState = PatchSwapFadingOut;
+
+    // The fade takes 10ms, so if this takes much longer the host has stopped calling us or uses very large blocks
+    auto const startTime = Time::getMillisecondCounter();
+    while (patchSwapState != PatchSwapSilent) {
+        if (Time::getMillisecondCounter() - startTime > 50) {
+            patchSwapState = PatchSwapIdle;
+            return false;
+        }
+        Thread::sleep(1);
+    }
+
+    return true;
+}
+
+template<typename SampleType>
+void PluginProcessor::processSamples(AudioBuffer<SampleType>& buffer, MidiBuffer& midiBuffer)
+{
+    audioThreadId = Thread::getCurrentThreadId();
+
+    // While a new state is being loaded, the message thread holds the audio lock for a long time
+    // We have already faded out, so we output silence instead of waiting for it
+    if (patchSwapState == PatchSwapSilent) {
+        buffer.clear();
+
+        // Keep the note-offs from the host, so the new patches still get them
+        for (auto event : midiBuffer) {
+            auto message = event.getMessage();
+            if (message.isNoteOff() || message.isAllNotesOff() || message.isAllSoundOff() || message.isSustainPedalOff())
+                scheduledHostMidi.addEvent(message, 0);
+        }
+        midiBuffer.clear();
+
+        // The old patches are gone, so end the notes they were playing
+        if (producesMidi() && !patchSwapSentNotesOff) {
+            for (int channel = 1; channel <= 16; channel++)
+                midiBuffer.addEvent(MidiMessage::allNotesOff(channel), 0);
+            patchSwapSentNotesOff = true;
+        }
+        return;
+    }
+    patchSwapSentNotesOff = false;
+
+    auto& state = getProcessingState<SampleType>();
+
     ScopedNoDenormals noDenormals;
     AudioProcessLoadMeasurer::ScopedTimer cpuTimer(cpuLoadMeasurer, buffer.getNumSamples());
 
+    lastAudioCallbackTime = Time::getMillisecondCounter();
+
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
-    if (!ProjectInfo::isStandalone && !midiBuffer.isEmpty()) {
-        midiDeviceManager.enqueueMidiInput(0, midiBuffer);
-    }
+    // Host MIDI is sent to Pd at the tick that contains it
+    // With a variable block size, the next tick starts with the samples that are still waiting in the input fifo
+    auto const eventPositionOffset = variableBlockSize ? state.inputFifo->getNumSamplesAvailable() : 0;
+    scheduleHostEvents(ProjectInfo::isStandalone ? MidiBuffer() : midiBuffer, eventPositionOffset);
+    playheadTickPosition = -eventPositionOffset;
 
     setThis();
     sendPlayhead();
@@ -630,8 +841,8 @@ void PluginProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiB
         buffer.clear(i, 0, buffer.getNumSamples());
     }
 
-    auto targetBlock = dsp::AudioBlock<float>(buffer);
-    auto blockOut = oversampling > 0 ? oversampler->processSamplesUp(targetBlock) : targetBlock;
+    auto targetBlock = dsp::AudioBlock<SampleType>(buffer);
+    auto blockOut = oversampling > 0 ? state.oversampler->processSamplesUp(targetBlock) : targetBlock;
 
     auto midiInputMessages = MidiBuffer(); // TODO: fix this!
 
@@ -642,7 +853,7 @@ void PluginProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiB
     }
 
     if (oversampling > 0) {
-        oversampler->processSamplesDown(targetBlock);
+        state.oversampler->processSamplesDown(targetBlock);
     }
 
     auto targetGain = volume->load();
@@ -674,7 +885,10 @@ void PluginProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiB
 
     // apply smoothing to the main volume control
     smoothedGain.setTargetValue(mappedTargetGain);
-    smoothedGain.applyGain(buffer, buffer.getNumSamples());
+    applySmoothedGain(smoothedGain, buffer);
+
+    if (patchSwapState != PatchSwapIdle || patchSwapGain.getCurrentValue() < 1.0f)
+        applyPatchSwapFade(buffer);
 
     midiDeviceManager.getLastMidiOutputEvents(midiOutputHistory, buffer.getNumSamples());
 
@@ -693,7 +907,10 @@ void PluginProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiB
     if (internalSynthPort >= 0 && internalSynth->isReady()) {
         midiBufferInternalSynth.clear();
         midiDeviceManager.dequeueMidiOutput(internalSynthPort, midiBufferInternalSynth, buffer.getNumSamples());
-        internalSynth->process(buffer, midiBufferInternalSynth);
+
+        // The internal synth only runs in the standalone, which always processes in single precision
+        if constexpr (std::is_same_v<SampleType, float>)
+            internalSynth->process(buffer, midiBufferInternalSynth);
     } else if (internalSynthPort < 0 && internalSynth->isReady()) {
         internalSynth->unprepare();
     } else if (internalSynthPort >= 0 && !internalSynth->isReady()) {
@@ -704,22 +921,19 @@ void PluginProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiB
     midiDeviceManager.sendMidiOutput();
 
     if (protectedMode && buffer.getNumChannels() > 0) {
-        // Take out inf and NaN values
-        auto* const* writePtr = buffer.getArrayOfWritePointers();
-        for (int ch = 0; ch < buffer.getNumChannels(); ch++) {
-            for (int n = 0; n < buffer.getNumSamples(); n++) {
-                if (!std::isfinite(writePtr[ch][n])) {
-                    writePtr[ch][n] = 0.0f;
-                }
-            }
-        }
+        // Don't let old audio out of the limiter's delay line when it was turned off for a while
+        if (!state.limiterActive)
+            state.limiter.reset();
 
-        auto block = dsp::AudioBlock<float>(buffer);
-        limiter.process(block);
+        // Takes out inf, NaN and denormal values, then limits true peaks
+        auto block = dsp::AudioBlock<SampleType>(buffer);
+        state.limiter.process(block);
     }
+    state.limiterActive = protectedMode;
 }
 
-void PluginProcessor::processConstant(dsp::AudioBlock<float> buffer, MidiBuffer& midiBuffer)
+template<typename SampleType>
+void PluginProcessor::processConstant(dsp::AudioBlock<SampleType> buffer, MidiBuffer& midiBuffer)
 {
     int pdBlockSize = Instance::getBlockSize();
     int numBlocks = buffer.getNumSamples() / pdBlockSize;
@@ -732,11 +946,16 @@ void PluginProcessor::processConstant(dsp::AudioBlock<float> buffer, MidiBuffer&
         midiByteBuffer[2] = 0;
     }
 
+    // We copy straight between the host buffer and Pd's own buffers, so every sample is only copied once in each direction
+    auto const dsp = getDSPBuffers();
+    auto const numChannels = static_cast<int>(buffer.getNumChannels());
+    auto const numInputs = std::min(numChannels, dsp.numInputs);
+    auto const numOutputs = std::min(numChannels, dsp.numOutputs);
+
     for (int block = 0; block < numBlocks; block++) {
-        for (int ch = 0; ch < buffer.getNumChannels(); ch++) {
-            // Copy the channel data into the vector
-            juce::FloatVectorOperations::copy(
-                audioVectorIn.data() + (ch * pdBlockSize),
+        for (int ch = 0; ch < numInputs; ch++) {
+            copySamples(
+                dsp.inputs + (ch * pdBlockSize),
                 buffer.getChannelPointer(ch) + audioAdvancement,
                 pdBlockSize);
         }
@@ -748,51 +967,61 @@ void PluginProcessor::processConstant(dsp::AudioBlock<float> buffer, MidiBuffer&
             sendMidiBuffer(port, buffer);
         });
 
+        sendScheduledEvents(pdBlockSize);
+        sendDirectMessagesFromQueue();
+
         // Process audio
-        performDSP(audioVectorIn.data(), audioVectorOut.data());
+        performDSP();
 
         sendMessagesFromQueue();
 
         if (connectionListener && plugdata_debugging_enabled())
             connectionListener.load()->updateSignalData();
 
-        for (int ch = 0; ch < buffer.getNumChannels(); ch++) {
-            // Use FloatVectorOperations to copy the vector data into the audioBuffer
-            juce::FloatVectorOperations::copy(
+        for (int ch = 0; ch < numOutputs; ch++) {
+            copySamples(
                 buffer.getChannelPointer(ch) + audioAdvancement,
-                audioVectorOut.data() + (ch * pdBlockSize),
+                dsp.outputs + (ch * pdBlockSize),
                 pdBlockSize);
         }
 
+        // Channels that are only inputs
+        for (int ch = numOutputs; ch < numChannels; ch++) {
+            FloatVectorOperations::clear(buffer.getChannelPointer(ch) + audioAdvancement, pdBlockSize);
+        }
+
         audioAdvancement += pdBlockSize;
     }
 }
 
-void PluginProcessor::processVariable(dsp::AudioBlock<float> buffer, MidiBuffer& midiBuffer)
+template<typename SampleType>
+void PluginProcessor::processVariable(dsp::AudioBlock<SampleType> buffer, MidiBuffer& midiBuffer)
 {
     auto const pdBlockSize = Instance::getBlockSize();
     auto const numChannels = buffer.getNumChannels();
 
-    inputFifo->writeAudio(buffer);
+    auto& state = getProcessingState<SampleType>();
+    state.inputFifo->writeAudio(buffer);
 
     audioAdvancement = 0; // Always has to be 0 if we use the AudioFifo!
 
-    while (inputFifo->getNumSamplesAvailable() >= pdBlockSize) {
-        inputFifo->readAudio(audioBufferIn);
+    // The fifos are read into and written from Pd's own buffers directly
+    auto const dsp = getDSPBuffers();
+    auto const numInputs = std::min(static_cast<int>(numChannels), dsp.numInputs);
+    auto const numOutputs = std::min(static_cast<int>(numChannels), dsp.numOutputs);
+
+    while (state.inputFifo->getNumSamplesAvailable() >= pdBlockSize) {
+        state.inputFifo->readRegions(pdBlockSize, [&dsp, numInputs, pdBlockSize](auto const& storage, int start, int offset, int size) {
+            for (int ch = 0; ch < numInputs; ch++) {
+                copySamples(dsp.inputs + (ch * pdBlockSize) + offset, storage.getReadPointer(ch, start), size);
+            }
+        });
 
         midiDeviceManager.dequeueMidiInput(pdBlockSize, [this](int port, int blockSize, MidiBuffer& buffer) {
             midiInputHistory.addEvents(buffer, 0, blockSize, 0);
             sendMidiBuffer(port, buffer);
         });
 
-        for (int channel = 0; channel < audioBufferIn.getNumChannels(); channel++) {
-            // Copy the channel data into the vector
-            juce::FloatVectorOperations::copy(
-                audioVectorIn.data() + (channel * pdBlockSize),
-                audioBufferIn.getReadPointer(channel),
-                pdBlockSize);
-        }
-
         if (producesMidi()) {
             midiByteIndex = 0;
             midiByteBuffer[0] = 0;
@@ -802,26 +1031,29 @@ void PluginProcessor::processVariable(dsp::AudioBlock<float> buffer, MidiBuffer&
 
         setThis();
 
+        sendScheduledEvents(pdBlockSize);
+        sendDirectMessagesFromQueue();
+
         // Process audio
-        performDSP(audioVectorIn.data(), audioVectorOut.data());
+        performDSP();
 
         sendMessagesFromQueue();
 
         if (connectionListener && plugdata_debugging_enabled())
             connectionListener.load()->updateSignalData();
 
-        for (int channel = 0; channel < numChannels; channel++) {
-            // Use FloatVectorOperations to copy the vector data into the audioBuffer
-            juce::FloatVectorOperations::copy(
-                audioBufferOut.getWritePointer(channel),
-                audioVectorOut.data() + (channel * pdBlockSize),
-                pdBlockSize);
-        }
-
-        outputFifo->writeAudio(audioBufferOut);
+        state.outputFifo->writeRegions(pdBlockSize, [&dsp, numOutputs, pdBlockSize](auto& storage, int start, int offset, int size) {
+            for (int ch = 0; ch < numOutputs; ch++) {
+                copySamples(storage.getWritePointer(ch, start), dsp.outputs + (ch * pdBlockSize) + offset, size);
+            }
+            // Channels that are only inputs
+            for (int ch = numOutputs; ch < storage.getNumChannels(); ch++) {
+                storage.clear(ch, start, size);
+            }
+        });
     }
 
-    outputFifo->readAudio(buffer);
+    state.outputFifo->readAudio(buffer);
 }
 
 void PluginProcessor::sendPlayhead()
@@ -831,78 +1063,169 @@ void PluginProcessor::sendPlayhead()
     if (!playhead)
         return;
 
-    auto infos = playhead->getPosition();
-
-    lockAudioThread();
-    setThis();
-    if (infos.hasValue()) {
-        atoms_playhead[0] = static_cast<float>(infos->getIsPlaying());
-        sendMessage("_playhead", "playing", atoms_playhead);
+    playheadInfo = playhead->getPosition();
+    if (!playheadInfo.hasValue())
+        return;
 
-        atoms_playhead[0] = static_cast<float>(infos->getIsRecording());
-        sendMessage("_playhead", "recording", atoms_playhead);
+    // Forget what we sent, so all fields are sent again
+    if (playheadRefreshRequested.exchange(false))
+        sentPlayheadState = PlayheadState();
 
-        atoms_playhead[0] = static_cast<float>(infos->getIsLooping());
+    auto const& infos = *playheadInfo;
+    PlayheadState state;
 
-        auto loopPoints = infos->getLoopPoints();
-        if (loopPoints.hasValue()) {
-            atoms_playhead.emplace_back(static_cast<float>(loopPoints->ppqStart));
-            atoms_playhead.emplace_back(static_cast<float>(loopPoints->ppqEnd));
-        } else {
-            atoms_playhead.emplace_back(0.0f);
-            atoms_playhead.emplace_back(0.0f);
+    auto setField = [&state](PlayheadField field, std::initializer_list<float> values) {
+        auto& result = state[field];
+        for (auto value : values) {
+            result.values[result.size++] = value;
         }
-        sendMessage("_playhead", "looping", atoms_playhead);
+    };
 
-        if (infos->getEditOriginTime().hasValue()) {
-            atoms_playhead.resize(1);
-            atoms_playhead[0] = static_cast<float>(*infos->getEditOriginTime());
-            sendMessage("_playhead", "edittime", atoms_playhead);
-        }
+    setField(PlayheadPlaying, { static_cast<float>(infos.getIsPlaying()) });
+    setField(PlayheadRecording, { static_cast<float>(infos.getIsRecording()) });
 
-        if (infos->getFrameRate().hasValue()) {
-            atoms_playhead.resize(1);
-            atoms_playhead[0] = static_cast<float>(infos->getFrameRate()->getEffectiveRate());
-            sendMessage("_playhead", "framerate", atoms_playhead);
-        }
+    auto loopPoints = infos.getLoopPoints();
+    if (loopPoints.hasValue()) {
+        setField(PlayheadLooping, { static_cast<float>(infos.getIsLooping()), static_cast<float>(loopPoints->ppqStart), static_cast<float>(loopPoints->ppqEnd) });
+    } else {
+        setField(PlayheadLooping, { static_cast<float>(infos.getIsLooping()), 0.0f, 0.0f });
+    }
 
-        if (infos->getBpm().hasValue()) {
-            atoms_playhead.resize(1);
-            atoms_playhead[0] = static_cast<float>(*infos->getBpm());
-            sendMessage("_playhead", "bpm", atoms_playhead);
-        }
+    if (infos.getEditOriginTime().hasValue())
+        setField(PlayheadEditTime, { static_cast<float>(*infos.getEditOriginTime()) });
 
-        if (infos->getPpqPositionOfLastBarStart().hasValue()) {
-            atoms_playhead.resize(1);
-            atoms_playhead[0] = static_cast<float>(*infos->getPpqPositionOfLastBarStart());
-            sendMessage("_playhead", "lastbar", atoms_playhead);
-        }
+    if (infos.getFrameRate().hasValue())
+        setField(PlayheadFrameRate, { static_cast<float>(infos.getFrameRate()->getEffectiveRate()) });
+
+    if (infos.getBpm().hasValue())
+        setField(PlayheadBpm, { static_cast<float>(*infos.getBpm()) });
+
+    if (infos.getPpqPositionOfLastBarStart().hasValue())
+        setField(PlayheadLastBar, { static_cast<float>(*infos.getPpqPositionOfLastBarStart()) });
+
+    if (infos.getTimeSignature().hasValue())
+        setField(PlayheadTimeSig, { static_cast<float>(infos.getTimeSignature()->numerator), static_cast<float>(infos.getTimeSignature()->denominator) });
+
+    // With interpolation enabled, the position is sent at every Pd tick instead
+    if (!playheadInterpolation)
+        state[PlayheadPosition] = getPlayheadPosition(0.0);
 
-        if (infos->getTimeSignature().hasValue()) {
-            atoms_playhead.resize(1);
-            atoms_playhead[0] = static_cast<float>(infos->getTimeSignature()->numerator);
-            atoms_playhead.emplace_back(static_cast<float>(infos->getTimeSignature()->denominator));
-            sendMessage("_playhead", "timesig", atoms_playhead);
+    // Most blocks only change the position, or nothing at all when the transport is stopped
+    bool locked = false;
+    for (int i = 0; i < NumPlayheadFields; i++) {
+        auto const& field = state[i];
+        if (field.size == 0 || field == sentPlayheadState[i])
+            continue;
+
+        if (!locked) {
+            lockAudioThread();
+            setThis();
+            locked = true;
         }
 
-        auto ppq = infos->getPpqPosition();
-        auto samplesTime = infos->getTimeInSamples();
-        auto secondsTime = infos->getTimeInSeconds();
-        if (ppq.hasValue() || samplesTime.hasValue() || secondsTime.hasValue()) {
-            atoms_playhead.resize(3);
-            atoms_playhead[0] = ppq.hasValue() ? static_cast<float>(*ppq) : 0.0f;
-            atoms_playhead[1] = samplesTime.hasValue() ? static_cast<float>(*samplesTime) : 0.0f;
-            atoms_playhead[2] = secondsTime.hasValue() ? static_cast<float>(*secondsTime) : 0.0f;
-            sendMessage("_playhead", "position", atoms_playhead);
+        static constexpr char const* selectors[NumPlayheadFields] = { "playing", "recording", "looping", "edittime", "framerate", "bpm", "lastbar", "timesig", "position" };
+
+        atoms_playhead.resize(field.size);
+        for (int n = 0; n < field.size; n++) {
+            atoms_playhead[n] = field.values[n];
         }
-        atoms_playhead.resize(1);
+        sendMessage("_playhead", selectors[i], atoms_playhead);
+        sentPlayheadState[i] = field;
+    }
+
+    if (locked)
+        unlockAudioThread();
+}
+
+PluginProcessor::PlayheadValues PluginProcessor::getPlayheadPosition(double sampleOffset) const
+{
+    PlayheadValues result;
+    if (!playheadInfo.hasValue())
+        return result;
+
+    auto const& infos = *playheadInfo;
+    auto ppq = infos.getPpqPosition();
+    auto samplesTime = infos.getTimeInSamples();
+    auto secondsTime = infos.getTimeInSeconds();
+    if (!ppq.hasValue() && !samplesTime.hasValue() && !secondsTime.hasValue())
+        return result;
+
+    // The host only reports the position at the start of the block, so we extrapolate from there while playing
+    if (!infos.getIsPlaying())
+        sampleOffset = 0.0;
+
+    auto const sampleRate = getSampleRate();
+    auto const secondsOffset = sampleRate > 0.0 ? sampleOffset / sampleRate : 0.0;
+    auto const ppqOffset = infos.getBpm().hasValue() ? secondsOffset * *infos.getBpm() / 60.0 : 0.0;
+
+    result.values[0] = ppq.hasValue() ? static_cast<float>(*ppq + ppqOffset) : 0.0f;
+    result.values[1] = samplesTime.hasValue() ? static_cast<float>(static_cast<double>(*samplesTime) + sampleOffset) : 0.0f;
+    result.values[2] = secondsTime.hasValue() ? static_cast<float>(*secondsTime + secondsOffset) : 0.0f;
+    result.size = 3;
+    return result;
+}
+
+void PluginProcessor::sendPlayheadPosition(int blockSize)
+{
+    auto const tickPosition = playheadTickPosition;
+    playheadTickPosition += blockSize;
+
+    if (!playheadInterpolation)
+        return;
+
+    // Tick positions are in oversampled samples, the host position isn't
+    auto position = getPlayheadPosition(static_cast<double>(tickPosition) / static_cast<double>(1 << oversampling));
+    if (position.size == 0 || position == sentPlayheadState[PlayheadPosition])
+        return;
+
+    atoms_playhead.resize(position.size);
+    for (int n = 0; n < position.size; n++) {
+        atoms_playhead[n] = position.values[n];
     }
+
+    // Unlike the libpd_* calls, sendMessage doesn't take the Pd lock itself
+    lockAudioThread();
+    sendMessage("_playhead", "position", atoms_playhead);
     unlockAudioThread();
+    sentPlayheadState[PlayheadPosition] = position;
+}
+
+void PluginProcessor::setPlayheadInterpolation(bool interpolate)
+{
+    playheadInterpolation = interpolate;
+}
+
+void PluginProcessor::requestPlayheadRefresh()
+{
+    playheadRefreshRequested = true;
 }
 
 void PluginProcessor::sendParameters()
 {
-    for (auto* param : getParameters()) {
+    auto const& parameters = getParameters();
+
+    // Every value the host set since the last block, in order
+    PlugDataParameter::ValueChange change;
+    for (size_t word = 0; word < dirtyParameters.size(); word++) {
+        auto bits = dirtyParameters[word].exchange(0, std::memory_order_acquire);
+        while (bits) {
+            auto const index = static_cast<int>(word * 64) + std::countr_zero(bits);
+            bits &= bits - 1;
+
+            auto* pldParam = reinterpret_cast<PlugDataParameter*>(parameters[index]);
+            while (pldParam->dequeueValueChange(change)) {
+                if (!pldParam->isEnabled())
+                    continue;
+
+                auto title = pldParam->getTitle();
+                sendFloat(title.data(), change.value);
+                pldParam->setLastValue(change.value);
+            }
+        }
+    }
+
+    // Values that changed without going through the host, for example from inside Pd
+    for (auto* param : parameters) {
         // We used to do dynamic_cast here, but since it gets called very often and param is always PlugDataParameter, we use reinterpret_cast now
         // this is probably UB...
         auto* pldParam = reinterpret_cast<PlugDataParameter*>(param);
@@ -918,6 +1241,44 @@ void PluginProcessor::sendParameters()
     }
 }
 
+void PluginProcessor::scheduleHostEvents(MidiBuffer const& midiBuffer, int positionOffset)
+{
+    // Host positions are in samples before oversampling
+    auto const oversamplingFactor = oversampling.load();
+
+    for (auto event : midiBuffer) {
+        scheduledHostMidi.addEvent(event.getMessage(), positionOffset + (event.samplePosition << oversamplingFactor));
+    }
+}
+
+void PluginProcessor::markParameterDirty(int const parameterIndex)
+{
+    if (isPositiveAndBelow(parameterIndex, numParameters))
+        dirtyParameters[parameterIndex >> 6].fetch_or(uint64(1) << (parameterIndex & 63), std::memory_order_release);
+}
+
+void PluginProcessor::sendScheduledEvents(int blockSize)
+{
+    sendPlayheadPosition(blockSize);
+
+    if (!scheduledHostMidi.isEmpty()) {
+        hostMidiBlock.clear();
+        scheduledHostMidiSwap.clear();
+        for (auto event : scheduledHostMidi) {
+            if (event.samplePosition < blockSize)
+                hostMidiBlock.addEvent(event.getMessage(), event.samplePosition);
+            else
+                scheduledHostMidiSwap.addEvent(event.getMessage(), event.samplePosition - blockSize);
+        }
+        std::swap(scheduledHostMidi, scheduledHostMidiSwap);
+
+        if (!hostMidiBlock.isEmpty()) {
+            midiInputHistory.addEvents(hostMidiBlock, 0, blockSize, 0);
+            sendMidiBuffer(0, hostMidiBlock);
+        }
+    }
+}
+
 MidiDeviceManager& PluginProcessor::getMidiDeviceManager()
 {
     return midiDeviceManager;
@@ -981,43 +1342,102 @@ AudioProcessorEditor* PluginProcessor::createEditor()
     return editor;
 }
 
-void PluginProcessor::getStateInformation(MemoryBlock& destData)
+// The state is stored compressed, after a stub in the legacy layout
+// The stub makes older versions load an empty session, instead of misreading the compressed data
+// Keeping a readable copy of the patches for older versions would mean storing all content uncompressed again
+static constexpr int compressedStateMagic = 0x74736470; // "pdst"
+static constexpr int compressedStateVersion = 1;
+
+// Reads the patch content table and full xml state that follow the legacy part of the state
+static std::unique_ptr<XmlElement> readCompressedState(InputStream& istream)
 {
-    setThis();
+    auto const version = istream.readInt();
+    if (version > compressedStateVersion) // Saved by a newer version, which might store things differently
+        return nullptr;
 
-    // Store pure-data and parameter state
-    MemoryOutputStream ostream(destData, false);
+    MemoryBlock compressed;
+    istream.readIntoMemoryBlock(compressed, istream.readInt());
+
+    MemoryInputStream compressedStream(compressed, false);
+    GZIPDecompressorInputStream decompressor(compressedStream);
+    MemoryBlock payloadData;
+    decompressor.readIntoMemoryBlock(payloadData);
 
-    ostream.writeInt(patches.size());
+    MemoryInputStream payload(payloadData, false);
 
+    StringArray contents;
+    auto const numContents = payload.readInt();
+    for (int i = 0; i < numContents; i++) {
+        contents.add(payload.readString());
+    }
 
-    auto presetDir = ProjectInfo::appDataDir.getChildFile("Extra").getChildFile("Presets");
+    MemoryBlock xmlData;
+    auto const xmlSize = payload.readInt();
+    payload.readIntoMemoryBlock(xmlData, xmlSize);
 
-    auto patchesTree = new XmlElement("Patches");
+    auto xml = AudioProcessor::getXmlFromBinary(xmlData.getData(), xmlSize);
+    if (!xml)
+        return nullptr;
+
+    // Put the content back in the place where the loader expects it
+    if (auto* patchTree = xml->getChildByName("Patches")) {
+        for (auto* p : patchTree->getChildWithTagNameIterator("Patch")) {
+            p->setAttribute("Content", contents[p->getIntAttribute("ContentIndex", -1)]);
+            p->removeAttribute("ContentIndex");
+        }
+    }
+
+    return xml;
+}
+
+void PluginProcessor::getStateInformation(MemoryBlock& destData)
+{
+    setThis();
+
+    // Take a snapshot of the patches with one short lock, everything else doesn't need Pd
+    struct PatchSnapshot {
+        String content;
+        String location;
+        bool pluginMode;
+        int splitIndex;
+    };
+
+    SmallArray<PatchSnapshot> snapshot;
+    snapshot.reserve(patches.size());
 
-    // Save path and content for patch
     lockAudioThread();
     for (auto const& patch : patches) {
+        snapshot.add({ patch->getCanvasContent(), patch->getCurrentFile().getFullPathName(), patch->openInPluginMode, patch->splitViewIndex });
+    }
+    unlockAudioThread();
 
-        auto content = patch->getCanvasContent();
-        auto patchFile = patch->getCurrentFile().getFullPathName();
-
-        // Write legacy format
-        ostream.writeString(content);
-        ostream.writeString(patchFile);
+    // Patches with the same content, like the same abstraction opened in multiple tabs, are only stored once
+    StringArray contents;
+    auto patchesTree = new XmlElement("Patches");
+    for (auto const& patch : snapshot) {
+        auto contentIndex = -1;
+        if (patch.content.isNotEmpty()) {
+            contentIndex = contents.indexOf(patch.content);
+            if (contentIndex < 0) {
+                contentIndex = contents.size();
+                contents.add(patch.content);
+            }
+        }
 
         auto* patchTree = new XmlElement("Patch");
-        // Write new format
-        patchTree->setAttribute("Content", content);
-        patchTree->setAttribute("Location", patchFile);
-        patchTree->setAttribute("PluginMode", patch->openInPluginMode);
-        patchTree->setAttribute("SplitIndex", patch->splitViewIndex);
+        patchTree->setAttribute("ContentIndex", contentIndex);
+        patchTree->setAttribute("Location", patch.location);
+        patchTree->setAttribute("PluginMode", patch.pluginMode);
+        patchTree->setAttribute("SplitIndex", patch.splitIndex);
 
         patchesTree->addChildElement(patchTree);
     }
-    unlockAudioThread();
 
-    ostream.writeInt(getLatencySamples() - Instance::getBlockSize());
+    MemoryOutputStream ostream(destData, false);
+
+    // Legacy format, without any patches
+    ostream.writeInt(0);
+    ostream.writeInt(customLatencySamples);
     ostream.writeInt(oversampling);
     ostream.writeFloat(getValue<float>(tailLength));
 
@@ -1027,7 +1447,8 @@ void PluginProcessor::getStateInformation(MemoryBlock& destData)
     // In the future, we're gonna load everything from xml, to make it easier to add new properties
     // By putting this here, we can prepare for making this change without breaking existing DAW saves
     xml.setAttribute("Oversampling", oversampling);
-    xml.setAttribute("Latency", getLatencySamples() - Instance::getBlockSize());
+    xml.setAttribute("OversamplingQuality", oversamplingQuality);
+    xml.setAttribute("Latency", customLatencySamples);
     xml.setAttribute("TailLength", getValue<float>(tailLength));
     xml.setAttribute("Legacy", false);
 
@@ -1053,11 +1474,41 @@ void PluginProcessor::getStateInformation(MemoryBlock& destData)
         }
     }
 
+    // Older versions only read this xml, so it has the settings but no patches or parameters
+    XmlElement stub("plugdata_save");
+    for (int i = 0; i < xml.getNumAttributes(); i++) {
+        stub.setAttribute(xml.getAttributeName(i), xml.getAttributeValue(i));
+    }
+
+    MemoryBlock stubBlock;
+    copyXmlToBinary(stub, stubBlock);
+
+    ostream.writeInt(static_cast<int>(stubBlock.getSize()));
+    ostream.write(stubBlock.getData(), stubBlock.getSize());
+
+    MemoryOutputStream payload;
+    payload.writeInt(contents.size());
+    for (auto const& content : contents) {
+        payload.writeString(content);
+    }
+
     MemoryBlock xmlBlock;
     copyXmlToBinary(xml, xmlBlock);
+    payload.writeInt(static_cast<int>(xmlBlock.getSize()));
+    payload.write(xmlBlock.getData(), xmlBlock.getSize());
 
-    ostream.writeInt(static_cast<int>(xmlBlock.getSize()));
-    ostream.write(xmlBlock.getData(), xmlBlock.getSize());
+    MemoryBlock compressed;
+    {
+        MemoryOutputStream compressedStream(compressed, false);
+        GZIPCompressorOutputStream compressor(compressedStream, 6);
+        compressor.write(payload.getData(), payload.getDataSize());
+        compressor.flush();
+    }
+
+    ostream.writeInt(compressedStateMagic);
+    ostream.writeInt(compressedStateVersion);
+    ostream.writeInt(static_cast<int>(compressed.getSize()));
+    ostream.write(compressed.getData(), compressed.getSize());
 
     // then detach extraData XmlElement from temporary tree xml for later re-use
     if (extraDataStored) {
@@ -1072,23 +1523,7 @@ void PluginProcessor::setStateInformation(void const* data, int sizeInBytes)
 
     MemoryInputStream istream(data, sizeInBytes, false);
 
-    lockAudioThread();
-
-    setThis();
-
-    patches.clear();
-
-    SmallArray<pd::WeakReference> openedPatches;
-    // Close all patches
-    for (auto* cnv = pd_getcanvaslist(); cnv; cnv = cnv->gl_next) {
-        openedPatches.add(pd::WeakReference(cnv, this));
-    }
-    for (auto patch : openedPatches) {
-        if (auto cnv = patch.get<t_glist*>()) {
-            libpd_closefile(cnv.get());
-        }
-    }
-
+    // Read everything from the state before we interrupt the audio
     int numPatches = istream.readInt();
 
     SmallArray<std::pair<String, File>> newPatches;
@@ -1113,6 +1548,32 @@ void PluginProcessor::setStateInformation(void const* data, int sizeInBytes)
 
     std::unique_ptr<XmlElement> xmlState(getXmlFromBinary(xmlData, xmlSize));
 
+    // Newer sessions have the full state after the legacy part, which is only a stub
+    if (istream.getNumBytesRemaining() >= 8 && istream.readInt() == compressedStateMagic) {
+        if (auto fullState = readCompressedState(istream))
+            xmlState = std::move(fullState);
+    }
+
+    // Fade out and let the audio thread output silence while we replace the patches, instead of blocking it
+    auto const fadedOut = fadeOutForPatchSwap();
+
+    lockAudioThread();
+
+    setThis();
+
+    patches.clear();
+
+    SmallArray<pd::WeakReference> openedPatches;
+    // Close all patches
+    for (auto* cnv = pd_getcanvaslist(); cnv; cnv = cnv->gl_next) {
+        openedPatches.add(pd::WeakReference(cnv, this));
+    }
+    for (auto patch : openedPatches) {
+        if (auto cnv = patch.get<t_glist*>()) {
+            libpd_closefile(cnv.get());
+        }
+    }
+
     auto openPatch = [this](String const& content, File const& location, bool pluginMode = false, int splitIndex = 0) {
         // CHANGED IN v0.9.0:
         // We now prefer loading the patch content over the patch file, if possible
@@ -1174,15 +1635,21 @@ void PluginProcessor::setStateInformation(void const* data, int sizeInBytes)
         auto versionString = String("0.6.1"); // latest version that didn't have version inside the daw state
 
         if (!xmlState->hasAttribute("Legacy") || xmlState->getBoolAttribute("Legacy")) {
-            setLatencySamples(legacyLatency + Instance::getBlockSize());
+            customLatencySamples = legacyLatency;
+            setOversamplingQuality(OversamplingMinimumPhase);
             setOversampling(legacyOversampling);
             tailLength = legacyTail;
         } else {
+            customLatencySamples = xmlState->getIntAttribute("Latency");
+            // Sessions from before the quality setting existed used the minimum phase IIR filters
+            setOversamplingQuality(xmlState->getIntAttribute("OversamplingQuality", OversamplingMinimumPhase));
             setOversampling(xmlState->getDoubleAttribute("Oversampling"));
-            setLatencySamples(xmlState->getDoubleAttribute("Latency") + Instance::getBlockSize());
             tailLength = xmlState->getDoubleAttribute("TailLength");
         }
 
+        // Oversampling only prepares again when it changed, but the custom latency might have
+        updateLatency();
+
         if (xmlState->hasAttribute("Version")) {
             versionString = xmlState->getStringAttribute("Version");
         }
@@ -1209,6 +1676,10 @@ void PluginProcessor::setStateInformation(void const* data, int sizeInBytes)
 
     unlockAudioThread();
 
+    // Only we move on from silence, so the audio thread can't have changed the state in the meantime
+    if (fadedOut)
+        patchSwapState = PatchSwapFadingIn;
+
     delete[] xmlData;
 
     if (auto* editor = dynamic_cast<PluginEditor*>(getActiveEditor())) {
@@ -1638,7 +2109,7 @@ void PluginProcessor::performLatencyCompensationChange(float value)
             editor->statusbar->setLatencyDisplay(customLatencySamples);
         }
 
-        setLatencySamples(customLatencySamples + Instance::getBlockSize());
+        updateLatency();
     }
 }
 
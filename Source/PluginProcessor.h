@@ -31,6 +31,7 @@ struct PlugDataLook;
 class PluginEditor;
 class ConnectionMessageDisplay;
 class Object;
+class PlugDataParameter;
 class PluginProcessor final : public AudioProcessor
     , public pd::Instance
     , public SettingsFileListener {
@@ -41,7 +42,15 @@ public:
 
     static AudioProcessor::BusesProperties buildBusesProperties();
 
+    // Filter design used for oversampling, from cheapest to most transparent
+    enum OversamplingQuality {
+        OversamplingDraft,
+        OversamplingMinimumPhase,
+        OversamplingLinearPhase
+    };
+
     void setOversampling(int amount);
+    void setOversamplingQuality(int quality);
     void setLimiterThreshold(int amount);
     void setProtectedMode(bool enabled);
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
@@ -57,8 +66,13 @@ public:
 #endif
 
     void processBlock(AudioBuffer<float>&, MidiBuffer&) override;
+    void processBlock(AudioBuffer<double>&, MidiBuffer&) override;
 
     void processBlockBypassed(AudioBuffer<float>& buffer, MidiBuffer&) override;
+    void processBlockBypassed(AudioBuffer<double>& buffer, MidiBuffer&) override;
+
+    // Only worth it when Pd itself runs in double precision, otherwise we'd be converting back and forth
+    bool supportsDoublePrecisionProcessing() const override;
 
     AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -98,8 +112,15 @@ public:
 
     void reloadAbstractions(File changedPatch, t_glist* except) override;
 
-    void processConstant(dsp::AudioBlock<float>, MidiBuffer& midiBuffer);
-    void processVariable(dsp::AudioBlock<float>, MidiBuffer& midiBuffer);
+    template<typename SampleType>
+    void processSamples(AudioBuffer<SampleType>& buffer, MidiBuffer& midiBuffer);
+    template<typename SampleType>
+    void processSamplesBypassed(AudioBuffer<SampleType>& buffer, MidiBuffer& midiBuffer);
+
+    template<typename SampleType>
+    void processConstant(dsp::AudioBlock<SampleType>, MidiBuffer& midiBuffer);
+    template<typename SampleType>
+    void processVariable(dsp::AudioBlock<SampleType>, MidiBuffer& midiBuffer);
 
     MidiDeviceManager& getMidiDeviceManager();
 
@@ -123,6 +144,14 @@ public:
     void sendPlayhead();
     void sendParameters();
 
+    // Queues host MIDI at a position relative to the start of the next Pd tick
+    // Parameter changes have no sample position in JUCE, so sendParameters sends them once per host block
+    void scheduleHostEvents(MidiBuffer const& midiBuffer, int positionOffset);
+    // Sends all scheduled events that fall within the next Pd tick
+    void sendScheduledEvents(int blockSize);
+    // Called by parameters when they have new host changes waiting in their queue
+    void markParameterDirty(int parameterIndex);
+
     SmallArray<PluginEditor*> getEditors() const;
 
     void performParameterChange(int type, SmallString const& name, float value) override;
@@ -132,6 +161,9 @@ public:
     void setParameterMode(SmallString const& name, int mode) override;
 
     void performLatencyCompensationChange(float value) override;
+
+    void setPlayheadInterpolation(bool interpolate) override;
+    void requestPlayheadRefresh() override;
     void sendParameterInfoChangeMessage();
 
     void fillDataBuffer(SmallArray<pd::Atom> const& list) override;
@@ -174,6 +206,7 @@ public:
     
     // Zero means no oversampling
     AtomicValue<int> oversampling = 0;
+    AtomicValue<int> oversamplingQuality = OversamplingMinimumPhase;
 
     std::unique_ptr<InternalSynth> internalSynth;
     AtomicValue<int> internalSynthPort = -1;
@@ -183,27 +216,77 @@ public:
     AtomicValue<ConnectionMessageDisplay*, Sequential> connectionListener = nullptr;
     std::unique_ptr<Autosave> autosave;
 
+    int getCustomLatencySamples() const { return customLatencySamples; }
+
 private:
+    // Reports the latency set by the patch, plus the latency that our own processing adds
+    void updateLatency();
+
     int customLatencySamples = 0;
+    AtomicValue<int> oversamplerLatencySamples = 0;
+    AtomicValue<int> limiterLatencySamples = 0;
 
     SmoothedValue<float, ValueSmoothingTypes::Linear> smoothedGain;
 
+    // Loading a state replaces all patches, which holds the audio lock for as long as loading takes
+    // This makes that reload click-free: the audio thread fades out, outputs silence without touching Pd until the new patches are in place, then fades in
+    // It is not a staged load, the audio still drops out for as long as loading takes. A libpd instance can only run one set of patches,
+    // so loading the new patches next to the old ones would need a second Pd instance
+    enum PatchSwapState {
+        PatchSwapIdle,
+        PatchSwapFadingOut,
+        PatchSwapSilent,
+        PatchSwapFadingIn
+    };
+
+    AtomicValue<int> patchSwapState = PatchSwapIdle;
+    SmoothedValue<float, ValueSmoothingTypes::Linear> patchSwapGain;
+    AtomicValue<Thread::ThreadID> audioThreadId = nullptr;
+    bool patchSwapSentNotesOff = false; // Only used by the audio thread
+
+    // Returns false if the audio thread isn't running, in which case there is nothing to fade
+    bool fadeOutForPatchSwap();
+
+    template<typename SampleType>
+    void applyPatchSwapFade(AudioBuffer<SampleType>& buffer);
+
     AtomicValue<int> audioAdvancement = 0;
+    AtomicValue<uint32, Relaxed> lastAudioCallbackTime = 0;
 
     bool variableBlockSize = false;
-    AudioBuffer<float> audioBufferIn;
-    AudioBuffer<float> audioBufferOut;
-    AudioBuffer<float> bypassBuffer;
 
-    HeapArray<float> audioVectorIn;
-    HeapArray<float> audioVectorOut;
+    // Everything in the audio callback that depends on the sample type the host gives us
+    // Only the one matching the processing precision is prepared
+    template<typename SampleType>
+    struct AudioProcessingState {
+        AudioBuffer<SampleType> bypassBuffer;
+
+        std::unique_ptr<AudioFifo<SampleType>> inputFifo;
+        std::unique_ptr<AudioFifo<SampleType>> outputFifo;
 
-    std::unique_ptr<AudioFifo> inputFifo;
-    std::unique_ptr<AudioFifo> outputFifo;
+        std::unique_ptr<dsp::Oversampling<SampleType>> oversampler;
+        Limiter<SampleType> limiter;
+        bool limiterActive = false;
+    };
+
+    AudioProcessingState<float> floatProcessing;
+    AudioProcessingState<double> doubleProcessing;
+
+    template<typename SampleType>
+    AudioProcessingState<SampleType>& getProcessingState();
+
+    template<typename SampleType>
+    void prepareProcessingState(AudioProcessingState<SampleType>& state, double sampleRate, int samplesPerBlock, int maxChannels);
 
     MidiBuffer midiInputHistory, midiOutputHistory;
     MidiBuffer midiBufferInternalSynth;
 
+    // One bit per parameter that has host changes waiting, so we don't have to check all of them every block
+    std::array<std::atomic<uint64>, numParameters / 64> dirtyParameters = {};
+
+    // Host MIDI, waiting for the Pd tick that contains it
+    MidiBuffer scheduledHostMidi, scheduledHostMidiSwap, hostMidiBlock;
+
     MidiDeviceManager midiDeviceManager;
 
     AudioProcessLoadMeasurer cpuLoadMeasurer;
@@ -212,12 +295,45 @@ private:
     uint8 midiByteBuffer[512] = { 0 };
     size_t midiByteIndex = 0;
 
+    // Playhead fields, in the order [playhead] outputs them
+    // We only send the fields that changed since they were last sent, instead of all of them on every block
+    enum PlayheadField {
+        PlayheadPlaying,
+        PlayheadRecording,
+        PlayheadLooping,
+        PlayheadEditTime,
+        PlayheadFrameRate,
+        PlayheadBpm,
+        PlayheadLastBar,
+        PlayheadTimeSig,
+        PlayheadPosition,
+        NumPlayheadFields
+    };
+
+    struct PlayheadValues {
+        std::array<float, 3> values = {};
+        int size = 0; // Zero if the host doesn't provide this field
+
+        bool operator==(PlayheadValues const& other) const = default;
+    };
+
+    using PlayheadState = std::array<PlayheadValues, NumPlayheadFields>;
+
+    PlayheadValues getPlayheadPosition(double sampleOffset) const;
+    void sendPlayheadPosition(int blockSize);
+
+    Optional<AudioPlayHead::PositionInfo> playheadInfo;
+    PlayheadState sentPlayheadState;
     SmallArray<pd::Atom> atoms_playhead;
 
+    // Position of the next Pd tick relative to the start of the host block, in (oversampled) samples
+    int playheadTickPosition = 0;
+
+    AtomicValue<bool> playheadInterpolation = false;
+    AtomicValue<bool> playheadRefreshRequested = false;
+
     int lastSetProgram = 0;
 
-    Limiter limiter;
-    std::unique_ptr<dsp::Oversampling<float>> oversampler;
 
     UnorderedMap<uint64_t, std::unique_ptr<Component>> textEditorDialogs;
 
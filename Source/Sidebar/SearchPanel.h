@@ -6,19 +6,9 @@
 
 #include "Object.h"
 #include "Objects/ObjectBase.h"
-#include "Objects/AllGuis.h"
 #include <m_pd.h>
 #include <m_imp.h>
 
-extern "C" {
-#include <g_all_guis.h>
-}
-
-static int srl_is_valid(t_symbol const* s)
-{
-    return (s != nullptr && s != gensym(""));
-}
-
 class OpenInspector : public Component {
     TextButton buttonOpenInspector;
 
@@ -278,12 +268,12 @@ public:
     {
         auto* cnv = editor->getCurrentCanvas();
         if (cnv && isVisible()) {
-            cnv->pd->lockAudioThread(); // It locks inside of this anyway, so we might as well lock around it to prevent constantly locking/unlocking
-
             // Get the currently selected object
             auto selectedObj = patchTree.getSelectedNodeObject();
 
-            patchTree.setValueTree(generatePatchTree(cnv->refCountedPatch));
+            // The snapshot is taken with a single lock, after that we only read our own copy
+            auto snapshot = cnv->refCountedPatch->getSnapshot(true);
+            patchTree.setValueTree(generatePatchTree(snapshot));
 
             // If the object is still selected, reselect it
             auto numSelectedObject = 0;
@@ -302,7 +292,6 @@ public:
                 patchTree.setSelectedNode(nullptr);
 
             patchTree.filterNodes();
-            cnv->pd->unlockAudioThread();
             patchTree.repaint();
         }
     }
@@ -323,7 +312,8 @@ public:
         patchTree.setBounds(tableBounds);
     }
 
-    ValueTree generatePatchTree(pd::Patch::Ptr patch, void* topLevel = nullptr)
+    // The object pointers are only used to identify objects, they are never read from
+    ValueTree generatePatchTree(pd::PatchSnapshot const& snapshot, void* topLevel = nullptr)
     {
         currentCanvas = editor->getCurrentCanvas();
 
@@ -331,22 +321,18 @@ public:
 
         int index = 0;
 
-        for (auto objectPtr : patch->getObjects()) {
-            if (auto object = objectPtr.get<t_pd>()) {
-                auto* top = topLevel ? topLevel : object.get();
-                String type = String::fromUTF8(pd::Interface::getObjectClassName(object.get()));
+        for (auto& snapshotObject : snapshot.objects) {
+            if (auto* object = snapshotObject.pointer) {
+                auto* top = topLevel ? topLevel : object;
+                String type = String::fromUTF8(snapshotObject.className);
 
-                if (!pd::Interface::checkObject(object.get()))
+                if (!snapshotObject.isPatchable)
                     continue;
 
-                char* objectText;
-                int len;
-                pd::Interface::getObjectText(object.cast<t_text>(), &objectText, &len);
+                auto x = snapshotObject.bounds.getX();
+                auto y = snapshotObject.bounds.getY();
 
-                int x, y, w, h;
-                pd::Interface::getObjectBounds(patch->getPointer().get(), object.cast<t_gobj>(), &x, &y, &w, &h);
-
-                auto name = String::fromUTF8(objectText, len);
+                auto name = snapshot.getText(snapshotObject);
                 auto nameWithoutArgs = name.upToFirstOccurrenceOf(" ", false, false);
                 auto positionText = " (" + String(x) + ":" + String(y) + ")";
 
@@ -355,33 +341,14 @@ public:
                 };
 
                 ValueTree element("Object");
-                if (type == "canvas" || type == "graph") {
-                    pd::Patch::Ptr subpatch = new pd::Patch(objectPtr, editor->pd, false);
-                    ValueTree subpatchTree = generatePatchTree(subpatch, top);
+                if (auto const& subpatch = snapshotObject.subpatch) {
+                    ValueTree subpatchTree = generatePatchTree(*subpatch, top);
                     element.copyPropertiesAndChildrenFrom(subpatchTree, nullptr);
 
-                    if (auto patchPtr = subpatch->getPointer()) {
-                        if (patchPtr->gl_list) {
-                            t_class* c = patchPtr->gl_list->g_pd;
-                            if (c && c->c_name && (String::fromUTF8(c->c_name->s_name) == "array")) {
-                                StringArray arrays;
-                                auto arrayIt = patchPtr->gl_list;
-                                while (arrayIt) {
-                                    if (auto* array = reinterpret_cast<t_fake_garray*>(arrayIt))
-                                        arrays.add(String::fromUTF8(array->x_name->s_name));
-                                    arrayIt = arrayIt->g_next;
-                                }
-                                String formatedArraysText;
-                                for (int i = 0; i < arrays.size(); i++) {
-                                    formatedArraysText += arrays[i] + String(i < arrays.size() - 1 ? ", " : "");
-                                }
-                                name = "array: " + formatedArraysText;
-                            } else if (patchPtr->gl_isgraph) {
-                                name = nameWithoutArgs;
-                            }
-                        } else if (patchPtr->gl_isgraph) {
-                            name = nameWithoutArgs;
-                        }
+                    if (!subpatch->arrayNames.isEmpty()) {
+                        name = "array: " + subpatch->arrayNames.joinIntoString(", ");
+                    } else if (subpatch->isGraph) {
+                        name = nameWithoutArgs;
                     }
 #ifdef SHOW_PD_SUBPATCH_SYMBOL
                     if (nameWithoutArgs == "pd") {
@@ -393,12 +360,12 @@ public:
                     element.setProperty("ObjectName", name, nullptr);
                     element.setProperty("Name", name, nullptr);
                     element.setProperty("RightText", positionText, nullptr);
-                    element.setProperty("Icon", canvas_isabstraction(subpatch->getPointer().get()) ? Icons::File : Icons::Object, nullptr);
-                    element.setProperty("Object", reinterpret_cast<int64>(object.cast<void>()), nullptr);
+                    element.setProperty("Icon", subpatch->isAbstraction ? Icons::File : Icons::Object, nullptr);
+                    element.setProperty("Object", reinterpret_cast<int64>(object), nullptr);
                     if (currentCanvas) {
                         for (auto comp : currentCanvas->getLassoSelection()) {
                             if (auto obj = dynamic_cast<Object*>(comp.get())) {
-                                if (obj->getPointer() == object.cast<t_gobj>()) {
+                                if (obj->getPointer() == object) {
                                     element.setProperty("Selected", true, nullptr);
                                 }
                             }
@@ -411,8 +378,8 @@ public:
                 } else {
                     String objectName = type;
                     String finalFormatedName;
-                    String sendSymbol;
-                    String receiveSymbol;
+                    String sendSymbol = String::fromUTF8(snapshotObject.sendSymbol);
+                    String receiveSymbol = String::fromUTF8(snapshotObject.receiveSymbol);
 
                     switch (hash(type)) {
                     // IEM send-receive symbols
@@ -425,70 +392,19 @@ public:
                     case hash("vradio"):
                     case hash("hradio"):
                     case hash("vu"):
-                    case hash("cnv"): {
-                        if (auto iemgui = objectPtr.get<t_iemgui>()) {
-                            t_symbol* srlsym[3];
-                            iemgui_all_sym2dollararg(iemgui.get(), srlsym);
-                            if (srl_is_valid(srlsym[0])) {
-                                sendSymbol = String::fromUTF8(iemgui->x_snd_unexpanded->s_name);
-                            }
-                            if (srl_is_valid(srlsym[1])) {
-                                receiveSymbol = String::fromUTF8(iemgui->x_rcv_unexpanded->s_name);
-                            }
-                        }
-                        finalFormatedName = nameWithoutArgs;
-                        break;
-                    }
-                    case hash("keyboard"): {
-                        if (auto keyboardObject = object.cast<t_fake_keyboard>()) {
-                            sendSymbol = String(keyboardObject->x_send->s_name);
-                            receiveSymbol = String(keyboardObject->x_receive->s_name);
-                        }
-                        finalFormatedName = nameWithoutArgs;
-                        break;
-                    }
-                    case hash("pic"): {
-                        if (auto picObject = object.cast<t_fake_pic>()) {
-                            sendSymbol = String(picObject->x_send->s_name);
-                            receiveSymbol = String(picObject->x_receive->s_name);
-                        }
-                        finalFormatedName = nameWithoutArgs;
-                        break;
-                    }
-                    case hash("scope~"): {
-                        if (auto scopeObject = object.cast<t_fake_scope>()) {
-                            receiveSymbol = String(scopeObject->x_receive->s_name);
-                        }
-                        finalFormatedName = nameWithoutArgs;
-                        break;
-                    }
-                    case hash("function"): {
-                        if (auto keyboardObject = object.cast<t_fake_function>()) {
-                            sendSymbol = String(keyboardObject->x_send->s_name);
-                            receiveSymbol = String(keyboardObject->x_receive->s_name);
-                        }
-                        finalFormatedName = nameWithoutArgs;
-                        break;
-                    }
-                    case hash("note"): {
-                        if (auto noteObject = object.cast<t_fake_note>()) {
-                            receiveSymbol = String(noteObject->x_receive->s_name);
-                        }
-                        finalFormatedName = nameWithoutArgs;
-                        break;
-                    }
+                    case hash("cnv"):
+                    case hash("keyboard"):
+                    case hash("pic"):
+                    case hash("scope~"):
+                    case hash("function"):
+                    case hash("note"):
                     case hash("knob"): {
-                        if (auto knobObj = object.cast<t_fake_knob>()) {
-                            sendSymbol = String(knobObj->x_snd->s_name);
-                            receiveSymbol = String(knobObj->x_rcv->s_name);
-                        }
                         finalFormatedName = nameWithoutArgs;
                         break;
                     }
                     case hash("gatom"): {
-                        auto gatomObject = object.cast<t_fake_gatom>();
                         String gatomName;
-                        switch (gatomObject->a_flavor) {
+                        switch (snapshotObject.atomType) {
                         case A_FLOAT:
                             gatomName = "floatbox";
                             break;
@@ -501,8 +417,6 @@ public:
                         default:
                             break;
                         }
-                        receiveSymbol = String(gatomObject->a_symfrom->s_name);
-                        sendSymbol = String(gatomObject->a_symto->s_name);
                         finalFormatedName = gatomName;
                         objectName = gatomName;
                         break;
@@ -516,7 +430,7 @@ public:
                         break;
                     }
                     case hash("text"): {
-                        switch (object.cast<t_fake_text_define>()->x_textbuf.b_ob.te_type) {
+                        switch (snapshotObject.textType) {
                         case T_TEXT: {
                             // if object & classname is text, then it's a comment
                             finalFormatedName = String("comment: ") + name;
@@ -610,11 +524,11 @@ public:
                     }
                     element.setProperty("RightText", positionText, nullptr);
                     element.setProperty("Icon", Icons::Object, nullptr);
-                    element.setProperty("Object", reinterpret_cast<int64>(object.cast<void>()), nullptr);
+                    element.setProperty("Object", reinterpret_cast<int64>(object), nullptr);
                     if (currentCanvas) {
                         for (auto comp : currentCanvas->getLassoSelection()) {
                             if (auto obj = dynamic_cast<Object*>(comp.get())) {
-                                if (obj->getPointer() == object.cast<t_gobj>())
+                                if (obj->getPointer() == object)
                                     element.setProperty("Selected", true, nullptr);
                             }
                         }
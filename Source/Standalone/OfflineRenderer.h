@@ -0,0 +1,225 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <iostream>
+
+// Renders a patch into an audio file as fast as possible, without opening any windows or audio devices
+//
+// plugdata --render patch.pd --output out.wav [--length seconds] [--samplerate 48000] [--channels 2]
+//                           [--input in.wav] [--midi in.mid]
+//
+// Output files ending in .raw or .f32 are written as interleaved 32-bit floats, anything else as a 32-bit float wav
+class OfflineRenderer {
+public:
+    static bool isRenderCommand(StringArray const& args)
+    {
+        return args.contains("--render");
+    }
+
+    explicit OfflineRenderer(StringArray const& args)
+    {
+        auto getOption = [&args](String const& name) -> String {
+            auto index = args.indexOf(name);
+            if (index < 0 || index + 1 >= args.size())
+                return {};
+            return args[index + 1].unquoted();
+        };
+
+        patchFile = File::getCurrentWorkingDirectory().getChildFile(getOption("--render"));
+        outputFile = File::getCurrentWorkingDirectory().getChildFile(getOption("--output"));
+
+        if (auto inputPath = getOption("--input"); inputPath.isNotEmpty())
+            inputFile = File::getCurrentWorkingDirectory().getChildFile(inputPath);
+        if (auto midiPath = getOption("--midi"); midiPath.isNotEmpty())
+            midiFile = File::getCurrentWorkingDirectory().getChildFile(midiPath);
+
+        lengthInSeconds = getOption("--length").getDoubleValue();
+        sampleRate = getOption("--samplerate").getDoubleValue();
+        numOutputChannels = getOption("--channels").getIntValue();
+        if (numOutputChannels <= 0)
+            numOutputChannels = 2;
+    }
+
+    // Returns the exit code for the application
+    int run()
+    {
+        if (!patchFile.existsAsFile() || !patchFile.hasFileExtension("pd"))
+            return fail("Patch not found: " + patchFile.getFullPathName());
+
+        if (outputFile == File() || outputFile.isDirectory())
+            return fail("No output file specified");
+
+        AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        std::unique_ptr<AudioFormatReader> inputReader;
+        if (inputFile != File()) {
+            inputReader.reset(formatManager.createReaderFor(inputFile));
+            if (!inputReader)
+                return fail("Couldn't read input file: " + inputFile.getFullPathName());
+
+            if (sampleRate <= 0.0)
+                sampleRate = inputReader->sampleRate;
+            else if (!approximatelyEqual(sampleRate, inputReader->sampleRate))
+                std::cerr << "Warning: input file sample rate doesn't match the render sample rate" << std::endl;
+
+            if (lengthInSeconds <= 0.0)
+                lengthInSeconds = static_cast<double>(inputReader->lengthInSamples) / inputReader->sampleRate;
+        }
+
+        MidiMessageSequence midiSequence;
+        if (midiFile != File()) {
+            FileInputStream midiStream(midiFile);
+            MidiFile midi;
+            if (!midiStream.openedOk() || !midi.readFrom(midiStream))
+                return fail("Couldn't read midi file: " + midiFile.getFullPathName());
+
+            midi.convertTimestampTicksToSeconds();
+            for (int i = 0; i < midi.getNumTracks(); i++) {
+                midiSequence.addSequence(*midi.getTrack(i), 0.0);
+            }
+            midiSequence.sort();
+
+            if (lengthInSeconds <= 0.0)
+                lengthInSeconds = midiSequence.getEndTime() + 1.0;
+        }
+
+        if (sampleRate <= 0.0)
+            sampleRate = 44100.0;
+        if (lengthInSeconds <= 0.0)
+            lengthInSeconds = 10.0;
+
+        auto const pdBlockSize = pd::Instance::getBlockSize();
+        auto const numInputChannels = inputReader ? static_cast<int>(inputReader->numChannels) : 0;
+        auto const numSamples = static_cast<int64>(std::ceil(lengthInSeconds * sampleRate));
+
+        auto processor = std::make_unique<PluginProcessor>();
+        processor->setPlayConfigDetails(numInputChannels, numOutputChannels, sampleRate, pdBlockSize);
+        processor->prepareToPlay(sampleRate, pdBlockSize);
+
+        if (!processor->loadPatch(URL(patchFile)))
+            return fail("Couldn't open patch: " + patchFile.getFullPathName());
+
+        auto writer = createWriter(sampleRate);
+        if (!writer)
+            return fail("Couldn't create output file: " + outputFile.getFullPathName());
+
+        // Pd works with non-interleaved channels, each one block long
+        auto const numPdInputs = jmin(numInputChannels, processor->getTotalNumInputChannels());
+        auto const numPdOutputs = jmin(numOutputChannels, processor->getTotalNumOutputChannels());
+        auto const maxChannels = jmax(processor->getTotalNumInputChannels(), processor->getTotalNumOutputChannels());
+        HeapArray<t_sample> audioVectorIn;
+        HeapArray<t_sample> audioVectorOut;
+        audioVectorIn.resize(maxChannels * pdBlockSize, 0.0f);
+        audioVectorOut.resize(maxChannels * pdBlockSize, 0.0f);
+
+        // We render in chunks so that the file writer doesn't get called for every Pd block
+        auto const chunkSize = pdBlockSize * 64;
+        AudioBuffer<float> inputChunk(jmax(1, numInputChannels), chunkSize);
+        AudioBuffer<float> outputChunk(numOutputChannels, chunkSize);
+        outputChunk.clear();
+
+        MidiBuffer midiBuffer;
+        int nextMidiEvent = 0;
+        auto const startTime = Time::getMillisecondCounterHiRes();
+
+        for (int64 position = 0; position < numSamples; position += chunkSize) {
+            inputChunk.clear();
+            if (inputReader)
+                inputReader->read(&inputChunk, 0, chunkSize, position, true, true);
+
+            for (int offset = 0; offset < chunkSize; offset += pdBlockSize) {
+                for (int ch = 0; ch < numPdInputs; ch++) {
+                    pd::Instance::copySamples(audioVectorIn.data() + ch * pdBlockSize, inputChunk.getReadPointer(ch, offset), pdBlockSize);
+                }
+
+                // Midi events are quantised to the Pd block they fall into
+                auto const blockEnd = static_cast<double>(position + offset + pdBlockSize) / sampleRate;
+                midiBuffer.clear();
+                while (nextMidiEvent < midiSequence.getNumEvents() && midiSequence.getEventTime(nextMidiEvent) < blockEnd) {
+                    midiBuffer.addEvent(midiSequence.getEventPointer(nextMidiEvent)->message, 0);
+                    nextMidiEvent++;
+                }
+
+                processor->setThis();
+                if (!midiBuffer.isEmpty())
+                    processor->sendMidiBuffer(0, midiBuffer);
+
+                processor->sendDirectMessagesFromQueue();
+                processor->performDSP(audioVectorIn.data(), audioVectorOut.data());
+                processor->sendMessagesFromQueue();
+
+                for (int ch = 0; ch < numPdOutputs; ch++) {
+                    pd::Instance::copySamples(outputChunk.getWritePointer(ch, offset), audioVectorOut.data() + ch * pdBlockSize, pdBlockSize);
+                }
+            }
+
+            auto const numToWrite = static_cast<int>(jmin<int64>(chunkSize, numSamples - position));
+            if (!writer(outputChunk, numToWrite))
+                return fail("Failed to write to output file");
+        }
+
+        auto const renderTime = (Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+        std::cout << "Rendered " << lengthInSeconds << "s of audio in " << renderTime << "s" << std::endl;
+
+        processor->releaseResources();
+        return 0;
+    }
+
+private:
+    std::function<bool(AudioBuffer<float> const&, int)> createWriter(double rate)
+    {
+        outputFile.deleteFile();
+
+        if (outputFile.hasFileExtension("raw;f32")) {
+            auto stream = std::make_shared<FileOutputStream>(outputFile);
+            if (!stream->openedOk())
+                return nullptr;
+
+            return [stream](AudioBuffer<float> const& buffer, int numSamples) {
+                for (int i = 0; i < numSamples; i++) {
+                    for (int ch = 0; ch < buffer.getNumChannels(); ch++) {
+                        if (!stream->writeFloat(buffer.getSample(ch, i)))
+                            return false;
+                    }
+                }
+                return true;
+            };
+        }
+
+        auto stream = std::make_unique<FileOutputStream>(outputFile);
+        if (!stream->openedOk())
+            return nullptr;
+
+        WavAudioFormat wavFormat;
+        std::shared_ptr<AudioFormatWriter> writer(wavFormat.createWriterFor(stream.get(), rate, static_cast<unsigned int>(numOutputChannels), 32, {}, 0));
+        if (!writer)
+            return nullptr;
+
+        stream.release(); // The writer now owns the stream
+
+        return [writer](AudioBuffer<float> const& buffer, int numSamples) {
+            return writer->writeFromAudioSampleBuffer(buffer, 0, numSamples);
+        };
+    }
+
+    static int fail(String const& message)
+    {
+        std::cerr << message << std::endl;
+        return 1;
+    }
+
+    File patchFile;
+    File outputFile;
+    File inputFile;
+    File midiFile;
+
+    double lengthInSeconds = 0.0;
+    double sampleRate = 0.0;
+    int numOutputChannels = 2;
+};
@@ -25,6 +25,7 @@
 #include "Pd/Setup.h"
 
 #include "PlugDataWindow.h"
+#include "OfflineRenderer.h"
 #include "Canvas.h"
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
@@ -105,6 +106,15 @@ public:
 
     void initialise(String const& arguments) override
     {
+        // Headless mode: render a patch to a file and quit, without creating any windows or audio devices
+        auto const args = StringArray::fromTokens(arguments, true);
+        if (OfflineRenderer::isRenderCommand(args)) {
+            OfflineRenderer renderer(args);
+            setApplicationReturnValue(renderer.run());
+            quit();
+            return;
+        }
+
         LookAndFeel::getDefaultLookAndFeel().setColour(ResizableWindow::backgroundColourId, Colours::transparentBlack);
 
         pluginHolder = std::make_unique<StandalonePluginHolder>(appProperties.getUserSettings(), false, "");
@@ -147,7 +157,8 @@ public:
     void shutdown() override
     {
         mainWindow = nullptr;
-        pluginHolder->stopPlaying();
+        if (pluginHolder)
+            pluginHolder->stopPlaying();
         pluginHolder = nullptr;
         appProperties.saveIfNeeded();
     }
@@ -244,7 +255,7 @@ public:
 
 protected:
     ApplicationProperties appProperties;
-    PlugDataWindow* mainWindow;
+    PlugDataWindow* mainWindow = nullptr;
 };
 
 void PlugDataWindow::closeAllPatches()
@@ -1263,7 +1263,7 @@ Statusbar::Statusbar(PluginProcessor* processor, PluginEditor* e)
     audioSettingsButton.setTooltip(String("Audio settings"));
     snapSettingsButton.setTooltip(String("Snap settings"));
 
-    setLatencyDisplay(pd->getLatencySamples() - pd::Instance::getBlockSize());
+    setLatencyDisplay(pd->getCustomLatencySamples());
 
     setSize(getWidth(), statusbarHeight);
 
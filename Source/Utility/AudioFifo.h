@@ -8,6 +8,7 @@
     Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
 */
 
+template<typename SampleType>
 class AudioFifo {
 public:
     AudioFifo(int channels, int maxSize)
@@ -32,7 +33,7 @@ public:
     int getNumSamplesAvailable() { return fifo.getNumReady(); }
     int getNumSamplesFree() { return fifo.getFreeSpace(); }
 
-    void writeAudio(dsp::AudioBlock<float> const& audioSrc)
+    void writeAudio(dsp::AudioBlock<SampleType> const& audioSrc)
     {
         jassert(getNumSamplesFree() >= audioSrc.getNumSamples());
         jassert(audioSrc.getNumChannels() == audioBuffer.getNumChannels());
@@ -48,7 +49,7 @@ public:
         fifo.finishedWrite(size1 + size2);
     }
 
-    void readAudio(dsp::AudioBlock<float>& audioDst)
+    void readAudio(dsp::AudioBlock<SampleType>& audioDst)
     {
         jassert(getNumSamplesAvailable() >= audioDst.getNumSamples());
         jassert(audioDst.getNumChannels() == audioBuffer.getNumChannels());
@@ -79,7 +80,7 @@ public:
         fifo.finishedWrite(size1 + size2);
     }
 
-    void writeAudio(juce::AudioBuffer<float> const& audioSrc)
+    void writeAudio(juce::AudioBuffer<SampleType> const& audioSrc)
     {
         jassert(getNumSamplesFree() >= audioSrc.getNumSamples());
         jassert(audioSrc.getNumChannels() == audioBuffer.getNumChannels());
@@ -98,7 +99,7 @@ public:
         fifo.finishedWrite(size1 + size2);
     }
 
-    void readAudio(juce::AudioBuffer<float>& audioDst)
+    void readAudio(juce::AudioBuffer<SampleType>& audioDst)
     {
         jassert(getNumSamplesAvailable() >= audioDst.getNumSamples());
         jassert(audioDst.getNumChannels() == audioBuffer.getNumChannels());
@@ -117,9 +118,44 @@ public:
         fifo.finishedRead(size1 + size2);
     }
 
+    // Reads without copying into an intermediate buffer first
+    // The callback gets the fifo's storage, a start index in it, the offset within the samples being read and a size, once for each contiguous region
+    template<typename Callback>
+    void readRegions(int numSamples, Callback&& callback)
+    {
+        jassert(getNumSamplesAvailable() >= numSamples);
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(numSamples, start1, size1, start2, size2);
+
+        if (size1 > 0)
+            callback(std::as_const(audioBuffer), start1, 0, size1);
+        if (size2 > 0)
+            callback(std::as_const(audioBuffer), start2, size1, size2);
+
+        fifo.finishedRead(size1 + size2);
+    }
+
+    // Same as readRegions, but the callback fills the storage it gets
+    template<typename Callback>
+    void writeRegions(int numSamples, Callback&& callback)
+    {
+        jassert(getNumSamplesFree() >= numSamples);
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+        if (size1 > 0)
+            callback(audioBuffer, start1, 0, size1);
+        if (size2 > 0)
+            callback(audioBuffer, start2, size1, size2);
+
+        fifo.finishedWrite(size1 + size2);
+    }
+
 private:
     AbstractFifo fifo { 1 };
-    AudioBuffer<float> audioBuffer;
+    AudioBuffer<SampleType> audioBuffer;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioFifo)
 };
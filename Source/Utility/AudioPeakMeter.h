@@ -21,13 +21,14 @@ public:
         lastPeak.resize(numChannels, 0);
     }
 
-    void write(AudioBuffer<float>& samples)
+    template<typename SampleType>
+    void write(AudioBuffer<SampleType>& samples)
     {
         for (int ch = 0; ch < std::min<int>(sampleQueue.size(), samples.getNumChannels()); ch++) {
             int index = 0;
             StackArray<float, 64> sampleBuffer;
             for (int i = 0; i < samples.getNumSamples(); i++) {
-                sampleBuffer[index] = samples.getSample(ch, i);
+                sampleBuffer[index] = static_cast<float>(samples.getSample(ch, i));
                 index++;
                 if(index >= 64) {
                     if(!sampleQueue[ch].try_enqueue(sampleBuffer))
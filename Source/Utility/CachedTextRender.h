@@ -6,7 +6,7 @@ public:
 
     void renderText(NVGcontext* nvg, Rectangle<int> const& bounds, float scale)
     {
-        if (updateImage || !image.isValid() || lastRenderBounds != bounds || lastScale != scale) {
+        if (updateImage || !isImageValid() || lastRenderBounds != bounds || lastScale != scale) {
             renderTextToImage(nvg, Rectangle<int>(bounds.getX(), bounds.getY(), bounds.getWidth() + 3, bounds.getHeight()), scale);
             lastRenderBounds = bounds;
             lastScale = scale;
@@ -15,7 +15,12 @@ public:
 
         NVGScopedState scopedState(nvg);
         nvgIntersectScissor(nvg, bounds.getX(), bounds.getY(), bounds.getWidth(), bounds.getHeight());
-        auto imagePattern = isSyntaxHighlighted ? nvgImagePattern(nvg, 0, 0, bounds.getWidth() + 3, bounds.getHeight(), 0, image.getImageId(), 1.0f) : nvgImageAlphaPattern(nvg, 0, 0, bounds.getWidth() + 3, bounds.getHeight(), 0, image.getImageId(), NVGComponent::convertColour(lastColour));
+        auto const colour = isSyntaxHighlighted ? nvgRGBA(255, 255, 255, 255) : NVGComponent::convertColour(lastColour);
+        NVGpaint imagePattern;
+        if (atlasImage.isValid())
+            imagePattern = atlasImage.getPaint({ 0.0f, 0.0f, bounds.getWidth() + 3.0f, static_cast<float>(bounds.getHeight()) }, colour);
+        else
+            imagePattern = isSyntaxHighlighted ? nvgImagePattern(nvg, 0, 0, bounds.getWidth() + 3, bounds.getHeight(), 0, image.getImageId(), 1.0f) : nvgImageAlphaPattern(nvg, 0, 0, bounds.getWidth() + 3, bounds.getHeight(), 0, image.getImageId(), colour);
 
         nvgFillPaint(nvg, imagePattern);
         nvgFillRect(nvg, bounds.getX(), bounds.getY(), bounds.getWidth() + 3, bounds.getHeight());
@@ -87,10 +92,23 @@ public:
         int width = std::floor(bounds.getWidth() * scale);
         int height = std::floor(bounds.getHeight() * scale);
 
-        image = NVGImage(nvg, width, height, [this, bounds, scale](Graphics& g) {
+        auto renderCall = [this, bounds, scale](Graphics& g) {
             g.addTransform(AffineTransform::scale(scale, scale));
             g.reduceClipRegion(bounds.withTrimmedRight(4)); // If it touches the edges of the image, it'll look bad
-            layout.draw(g, bounds.toFloat()); }, isSyntaxHighlighted ? 0 : NVGImage::AlphaImage);
+            layout.draw(g, bounds.toFloat());
+        };
+
+        // Most text is small enough to share a texture with other objects, only very long comments get their own image
+        if (atlasImage.render(nvg, width, height, renderCall, !isSyntaxHighlighted)) {
+            image = NVGImage();
+        } else {
+            image = NVGImage(nvg, width, height, renderCall, isSyntaxHighlighted ? 0 : NVGImage::AlphaImage);
+        }
+    }
+
+    bool isImageValid()
+    {
+        return atlasImage.isValid() || image.isValid();
     }
 
     Rectangle<int> getTextBounds()
@@ -99,6 +117,7 @@ public:
     }
 
 private:
+    NVGAtlasImage atlasImage;
     NVGImage image;
     hash32 lastTextHash = 0;
     float lastScale = 1.0f;
@@ -0,0 +1,233 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <queue>
+#include "Utility/Containers.h"
+
+// Finds segmented connection paths around objects, with A* over a grid of occupied cells
+// Build one router for a batch of connections: the grid is only rasterised once, and the search buffers are reused
+class ConnectionRouter {
+public:
+    explicit ConnectionRouter(Rectangle<int> routingArea)
+    {
+        // Keep the grid at a reasonable size for very large areas, by making the cells bigger
+        auto const area = static_cast<double>(routingArea.getWidth()) * routingArea.getHeight();
+        cellSize = jmax(minCellSize, static_cast<int>(std::ceil(std::sqrt(area / maxCells))));
+
+        origin = routingArea.getPosition();
+        columns = jmax(1, (routingArea.getWidth() + cellSize - 1) / cellSize);
+        rows = jmax(1, (routingArea.getHeight() + cellSize - 1) / cellSize);
+
+        blocked.resize(columns * rows, 0);
+        costs.resize(columns * rows * numDirections, 0);
+        parents.resize(columns * rows * numDirections, -1);
+        visited.resize(columns * rows * numDirections, 0);
+    }
+
+    // Marks everything within the clearance around the bounds as occupied
+    void addObstacle(Rectangle<int> bounds)
+    {
+        bounds = bounds.expanded(clearance);
+        auto const x1 = jmax(0, floorDiv(bounds.getX() - origin.x));
+        auto const y1 = jmax(0, floorDiv(bounds.getY() - origin.y));
+        auto const x2 = jmin(columns - 1, floorDiv(bounds.getRight() - 1 - origin.x));
+        auto const y2 = jmin(rows - 1, floorDiv(bounds.getBottom() - 1 - origin.y));
+
+        for (int y = y1; y <= y2; y++) {
+            for (int x = x1; x <= x2; x++) {
+                blocked[y * columns + x] = 1;
+            }
+        }
+    }
+
+    // Returns the corner points of a path that leaves the start downwards and enters the end from above
+    // The points are on cell centres: the first and last segments are vertical, so they can be snapped to the exact iolet positions
+    // Returns an empty plan if there is no path, or if we couldn't find it within the time budget
+    SmallArray<Point<float>> route(Point<float> start, Point<float> end, double timeBudgetMs = 20.0)
+    {
+        // The iolets are on the edge of their objects, so we start below the outlet and end above the inlet
+        // Those cells are always allowed, even though they are usually within the clearance around the objects
+        auto const startCell = getCell(start) + columns;
+        auto const endCell = getCell(end) - columns;
+        if (startCell >= columns * rows || endCell < 0)
+            return {};
+
+        // Stamps let us reuse the search buffers without clearing them
+        if (++currentStamp == 0) {
+            std::fill(visited.begin(), visited.end(), 0);
+            currentStamp = 1;
+        }
+
+        auto const endX = endCell % columns;
+        auto const endY = endCell / columns;
+        auto const getHeuristic = [this, endX, endY](int cell) {
+            return std::abs(cell % columns - endX) + std::abs(cell / columns - endY);
+        };
+
+        openList = {};
+        auto const startState = startCell * numDirections + Down;
+        setCost(startState, 0, -1);
+        openList.push({ getHeuristic(startCell), 0, startState });
+
+        auto const startTime = Time::getMillisecondCounterHiRes();
+        int numExpanded = 0;
+
+        while (!openList.empty()) {
+            auto const node = openList.top();
+            openList.pop();
+
+            if (node.cost > costs[node.state])
+                continue; // We already found a cheaper way here
+
+            auto const cell = node.state / numDirections;
+            auto const direction = node.state % numDirections;
+
+            if (cell == endCell)
+                return createPlan(node.state, start, end);
+
+            if (++numExpanded % 256 == 0 && Time::getMillisecondCounterHiRes() - startTime > timeBudgetMs)
+                return {};
+
+            auto const x = cell % columns;
+            auto const y = cell / columns;
+
+            for (int next = 0; next < numDirections; next++) {
+                // Turning back is never useful
+                if (next == (direction + 2) % numDirections)
+                    continue;
+
+                auto const nextX = x + directionX[next];
+                auto const nextY = y + directionY[next];
+                if (nextX < 0 || nextY < 0 || nextX >= columns || nextY >= rows)
+                    continue;
+
+                auto const nextCell = nextY * columns + nextX;
+                if (blocked[nextCell] && nextCell != endCell)
+                    continue;
+
+                // Corners cost extra, so we prefer simple paths, and we prefer to come into the inlet from above
+                auto cost = node.cost + 1 + (next != direction ? turnCost : 0);
+                if (nextCell == endCell && next != Down)
+                    cost += turnCost;
+
+                auto const nextState = nextCell * numDirections + next;
+                if (visited[nextState] == currentStamp && costs[nextState] <= cost)
+                    continue;
+
+                setCost(nextState, cost, node.state);
+                openList.push({ cost + getHeuristic(nextCell), cost, nextState });
+            }
+        }
+
+        return {};
+    }
+
+private:
+    enum Direction {
+        Down,
+        Right,
+        Up,
+        Left,
+        numDirections
+    };
+
+    static constexpr int directionX[numDirections] = { 0, 1, 0, -1 };
+    static constexpr int directionY[numDirections] = { 1, 0, -1, 0 };
+
+    static constexpr int minCellSize = 10;
+    static constexpr int clearance = 4;
+    static constexpr int turnCost = 3;
+    static constexpr double maxCells = 250000.0;
+
+    struct Node {
+        int estimate;
+        int cost;
+        int state;
+
+        bool operator<(Node const& other) const
+        {
+            // Reversed, so the priority queue gives us the lowest estimate first
+            return estimate > other.estimate;
+        }
+    };
+
+    int floorDiv(int value) const
+    {
+        return value >= 0 ? value / cellSize : (value - cellSize + 1) / cellSize;
+    }
+
+    int getCell(Point<float> position) const
+    {
+        auto const x = std::clamp(floorDiv(static_cast<int>(position.x) - origin.x), 0, columns - 1);
+        auto const y = std::clamp(floorDiv(static_cast<int>(position.y) - origin.y), 0, rows - 1);
+        return y * columns + x;
+    }
+
+    Point<float> getCellCentre(int cell) const
+    {
+        return { static_cast<float>(origin.x + (cell % columns) * cellSize + cellSize / 2), static_cast<float>(origin.y + (cell / columns) * cellSize + cellSize / 2) };
+    }
+
+    void setCost(int state, int cost, int parent)
+    {
+        costs[state] = cost;
+        parents[state] = parent;
+        visited[state] = currentStamp;
+    }
+
+    SmallArray<Point<float>> createPlan(int endState, Point<float> start, Point<float> end) const
+    {
+        SmallArray<int> cells;
+        for (auto state = endState; state >= 0; state = parents[state]) {
+            cells.add(state / numDirections);
+        }
+        std::reverse(cells.begin(), cells.end());
+
+        // Vertical segments from the iolets to the first and last cells, and only keep the points where the direction changes
+        SmallArray<Point<float>> points;
+        auto const firstCentre = getCellCentre(cells.front());
+        auto const lastCentre = getCellCentre(cells.back());
+        points.add({ firstCentre.x, start.y });
+        for (auto cell : cells) {
+            points.add(getCellCentre(cell));
+        }
+        points.add({ lastCentre.x, end.y });
+
+        SmallArray<Point<float>> plan;
+        plan.add(points.front());
+        for (int i = 1; i < points.size() - 1; i++) {
+            auto const& previous = plan.back();
+            auto const& next = points[i + 1];
+            auto const collinear = (approximatelyEqual(previous.x, points[i].x) && approximatelyEqual(points[i].x, next.x)) || (approximatelyEqual(previous.y, points[i].y) && approximatelyEqual(points[i].y, next.y));
+            if (!collinear && points[i] != previous)
+                plan.add(points[i]);
+        }
+        plan.add(points.back());
+
+        // A single straight line can't be snapped to iolets that aren't exactly above each other, so give it a jog halfway
+        if (plan.size() == 2) {
+            auto const middle = Point<float>(plan[0].x, (plan[0].y + plan[1].y) * 0.5f);
+            plan.insert(plan.begin() + 1, { middle, middle });
+        }
+
+        return plan;
+    }
+
+    Point<int> origin;
+    int cellSize = minCellSize;
+    int columns = 1;
+    int rows = 1;
+
+    HeapArray<uint8> blocked;
+    HeapArray<int> costs;
+    HeapArray<int> parents;
+    HeapArray<uint32> visited;
+    uint32 currentStamp = 0;
+
+    std::priority_queue<Node, std::vector<Node>> openList;
+};
@@ -2273,15 +2273,15 @@ public:
         std::sort(data_.begin(), data_.end(), sort_fn);
     }
 
+    // Removes in a single pass, instead of shifting the array for every removed element
     template<typename PredicateType>
     int remove_if(PredicateType&& predicate)
     {
-        int num_removed = 0;
-        for (int i = data_.size(); --i >= 0;) {
-            if (predicate(data_[i])) {
-                erase(i);
-                ++num_removed;
-            }
+        auto to_remove = std::stable_partition(data_.begin(), data_.end(), [&predicate](T* ptr) { return !predicate(ptr); });
+        int num_removed = static_cast<int>(data_.end() - to_remove);
+
+        for (int i = 0; i < num_removed; i++) {
+            deallocate_and_destroy(data_.pop_back_val());
         }
 
         return num_removed;
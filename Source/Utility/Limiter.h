@@ -6,19 +6,30 @@
 
 #pragma once
 
+#include <bit>
+#include <numeric>
+
+// Lookahead brickwall limiter that works on true peaks (estimated at 4x the sample rate), so it won't overshoot between samples
+// The gain is shared between all channels, which keeps the stereo image intact
+template<typename SampleType>
 class Limiter {
 public:
     Limiter() = default;
 
-    void process(dsp::AudioBlock<float>& block) noexcept
+    void process(dsp::AudioBlock<SampleType>& block) noexcept
     {
-        firstStageCompressor.process(dsp::ProcessContextReplacing<float>(block));
-        secondStageCompressor.process(dsp::ProcessContextReplacing<float>(block));
+        auto const numChannels = std::min<int>(static_cast<int>(block.getNumChannels()), delayBuffer.getNumChannels());
+        if (numChannels == 0)
+            return;
+
+        for (int ch = 0; ch < numChannels; ch++) {
+            removeInvalidSamples(block.getChannelPointer(ch), block.getNumSamples());
+        }
 
-        for (size_t channel = 0; channel < block.getNumChannels(); ++channel) {
-            // Clip if limter goes far out of bounds
-            // We'd rather not do hard clipping, but it's for the better when things get really loud
-            FloatVectorOperations::clip(block.getChannelPointer(channel), block.getChannelPointer(channel), -std::sqrt(2.0f), std::sqrt(2.0f), block.getNumSamples());
+        // Process in chunks that fit in our delay buffer, in case the host sends in a larger block than it promised
+        for (size_t offset = 0; offset < block.getNumSamples(); offset += maxBlockSize) {
+            auto const numSamples = static_cast<int>(std::min<size_t>(maxBlockSize, block.getNumSamples() - offset));
+            processChunk(block.getSubBlock(offset, numSamples), numChannels, numSamples);
         }
     }
 
@@ -28,9 +39,27 @@ public:
         jassert(spec.numChannels > 0);
 
         sampleRate = spec.sampleRate;
+        maxBlockSize = std::max<int>(1, static_cast<int>(spec.maximumBlockSize));
 
-        firstStageCompressor.prepare(spec);
-        secondStageCompressor.prepare(spec);
+        lookahead = std::max(interpolatorTaps, roundToInt(sampleRate * lookaheadTime / 1000.0));
+        windowSize = lookahead + 1;
+
+        delayBuffer.setSize(static_cast<int>(spec.numChannels), getLatencyInSamples() + maxBlockSize);
+        peaks.resize(maxBlockSize);
+        gains.resize(maxBlockSize);
+        minimumQueue.resize(windowSize);
+        smoothingHistory.resize(windowSize);
+
+        // Windowed sinc interpolators for the three points between each pair of samples
+        for (int phase = 0; phase < interpolatorPhases - 1; phase++) {
+            auto const fraction = static_cast<double>(phase + 1) / interpolatorPhases;
+            for (int tap = 0; tap < interpolatorTaps; tap++) {
+                auto const distance = fraction + (interpolatorTaps / 2 - 1) - tap;
+                auto const sinc = std::sin(MathConstants<double>::pi * distance) / (MathConstants<double>::pi * distance);
+                auto const window = 0.5 + 0.5 * std::cos(MathConstants<double>::pi * distance / (interpolatorTaps / 2 + 0.5));
+                interpolator[phase][tap] = static_cast<SampleType>(sinc * window);
+            }
+        }
 
         update();
         reset();
@@ -38,8 +67,14 @@ public:
 
     void reset()
     {
-        firstStageCompressor.reset();
-        secondStageCompressor.reset();
+        delayBuffer.clear();
+        std::fill(smoothingHistory.begin(), smoothingHistory.end(), 1.0f);
+        smoothingIndex = 0;
+        smoothingSum = windowSize;
+        envelope = 1.0f;
+        queueStart = 0;
+        queueSize = 0;
+        time = 0;
     }
 
     void setThreshold(float newThreshold)
@@ -48,24 +83,143 @@ public:
         update();
     }
 
+    // The audio is delayed until the gain reduction has fully faded in
+    int getLatencyInSamples() const
+    {
+        return lookahead + interpolatorTaps / 2;
+    }
+
+    // Zeroes NaN, inf and denormal samples
+    // There are no branches, so the compiler can vectorise this to SSE/NEON
+    static void removeInvalidSamples(SampleType* samples, size_t numSamples) noexcept
+    {
+        using Bits = std::conditional_t<std::is_same_v<SampleType, double>, uint64, uint32>;
+        constexpr int mantissaBits = std::numeric_limits<SampleType>::digits - 1;
+        constexpr Bits exponentMask = static_cast<Bits>(~Bits(0) << mantissaBits) & (~Bits(0) >> 1);
+
+        for (size_t i = 0; i < numSamples; i++) {
+            auto const bits = std::bit_cast<Bits>(samples[i]);
+            auto const exponent = bits & exponentMask;
+
+            // An exponent of all zeros means zero or denormal, all ones means inf or NaN
+            auto const keep = Bits(0) - static_cast<Bits>(exponent != 0 && exponent != exponentMask);
+            samples[i] = std::bit_cast<SampleType>(bits & keep);
+        }
+    }
+
 private:
+    static constexpr int interpolatorPhases = 4;
+    static constexpr int interpolatorTaps = 12;
+    static constexpr double lookaheadTime = 1.0; // ms
+
+    void processChunk(dsp::AudioBlock<SampleType> block, int numChannels, int numSamples) noexcept
+    {
+        auto const latency = getLatencyInSamples();
+
+        // The delay buffer holds the samples that are still delayed, followed by the new block
+        for (int ch = 0; ch < numChannels; ch++) {
+            FloatVectorOperations::copy(delayBuffer.getWritePointer(ch, latency), block.getChannelPointer(ch), numSamples);
+        }
+
+        // Find the true peak around the sample that is half the interpolator length back
+        std::fill_n(peaks.data(), numSamples, SampleType(0));
+        for (int ch = 0; ch < numChannels; ch++) {
+            auto const* input = delayBuffer.getReadPointer(ch, latency - interpolatorTaps + 1);
+            for (int i = 0; i < numSamples; i++) {
+                auto const* taps = input + i;
+                auto peak = std::abs(taps[interpolatorTaps / 2 - 1]);
+                for (int phase = 0; phase < interpolatorPhases - 1; phase++) {
+                    SampleType interpolated = 0;
+                    for (int tap = 0; tap < interpolatorTaps; tap++) {
+                        interpolated += taps[tap] * interpolator[phase][tap];
+                    }
+                    peak = std::max(peak, std::abs(interpolated));
+                }
+                peaks[i] = std::max(peaks[i], peak);
+            }
+        }
+
+        for (int i = 0; i < numSamples; i++) {
+            gains[i] = static_cast<SampleType>(getNextGain(static_cast<float>(peaks[i])));
+        }
+
+        for (int ch = 0; ch < numChannels; ch++) {
+            auto* delayed = delayBuffer.getWritePointer(ch);
+            auto* output = block.getChannelPointer(ch);
+            FloatVectorOperations::multiply(output, delayed, gains.data(), numSamples);
+
+            // Shift the samples that are still delayed back to the start
+            std::copy(delayed + numSamples, delayed + numSamples + latency, delayed);
+
+            // We'd rather not do hard clipping, but it's for the better if anything ever gets through
+            FloatVectorOperations::clip(output, output, -std::sqrt(SampleType(2)), std::sqrt(SampleType(2)), numSamples);
+        }
+    }
+
+    float getNextGain(float peak) noexcept
+    {
+        auto const required = peak > threshold ? threshold / peak : 1.0f;
+
+        // Minimum of the required gain over the lookahead window, using a queue with increasing values
+        if (queueSize > 0 && time - minimumQueue[queueStart].time >= static_cast<uint32>(windowSize)) {
+            queueStart = (queueStart + 1) % windowSize;
+            queueSize--;
+        }
+        while (queueSize > 0 && minimumQueue[(queueStart + queueSize - 1) % windowSize].gain >= required)
+            queueSize--;
+        minimumQueue[(queueStart + queueSize) % windowSize] = { required, time };
+        queueSize++;
+        time++;
+
+        // Attack immediately and release exponentially
+        auto const minimum = minimumQueue[queueStart].gain;
+        envelope = minimum < envelope ? minimum : envelope + (minimum - envelope) * releaseCoefficient;
+
+        // Averaging over the window makes the gain fade in over the lookahead time, and reach the required gain on the peak itself
+        smoothingSum += envelope - smoothingHistory[smoothingIndex];
+        smoothingHistory[smoothingIndex] = envelope;
+        if (++smoothingIndex == windowSize) {
+            smoothingIndex = 0;
+            // Start again from the exact sum, so rounding errors don't add up
+            smoothingSum = std::accumulate(smoothingHistory.begin(), smoothingHistory.end(), 0.0);
+        }
+
+        return std::min(1.0f, static_cast<float>(smoothingSum / windowSize));
+    }
+
     void update()
     {
-        firstStageCompressor.setThreshold(thresholddB - 2.0f);
-        firstStageCompressor.setRatio(4.0f);
-        firstStageCompressor.setAttack(2.0f);
-        firstStageCompressor.setRelease(200.0f);
-
-        secondStageCompressor.setThreshold(thresholddB);
-        secondStageCompressor.setRatio(1000.0f);
-        secondStageCompressor.setAttack(0.001f);
-        secondStageCompressor.setRelease(releaseTime);
+        threshold = Decibels::decibelsToGain(thresholddB);
+        releaseCoefficient = 1.0f - std::exp(-1.0f / static_cast<float>(releaseTime * 0.001 * sampleRate));
     }
 
     //==============================================================================
-    dsp::Compressor<float> firstStageCompressor, secondStageCompressor;
+    struct QueueEntry {
+        float gain;
+        uint32 time;
+    };
+
+    AudioBuffer<SampleType> delayBuffer;
+    HeapArray<SampleType> peaks;
+    HeapArray<SampleType> gains;
+    HeapArray<QueueEntry> minimumQueue;
+    HeapArray<float> smoothingHistory;
+    SampleType interpolator[interpolatorPhases - 1][interpolatorTaps] = {};
+
+    int queueStart = 0;
+    int queueSize = 0;
+    uint32 time = 0;
+    int smoothingIndex = 0;
+    double smoothingSum = 0.0;
+    float envelope = 1.0f;
+
+    int maxBlockSize = 512;
+    int lookahead = interpolatorTaps;
+    int windowSize = interpolatorTaps + 1;
 
     double sampleRate = 44100.0;
     float releaseTime = 100.0;
     float thresholddB = -6.0f;
+    float threshold = 0.5f;
+    float releaseCoefficient = 0.0f;
 };
@@ -141,10 +141,25 @@ public:
         return range.convertTo0to1(value);
     }
 
+    // Every change from the host is queued, so the processor can send all of them to Pd in order
     void setValue(float newValue) override
     {
         auto range = getNormalisableRange();
         value = range.convertFrom0to1(newValue);
+
+        // If the queue is full, the processor will still pick up the latest value
+        valueChanges.tryEnqueue({ value });
+        processor.markParameterDirty(getParameterIndex());
+    }
+
+    struct ValueChange {
+        float value;
+    };
+
+    // Only call this from the audio thread
+    bool dequeueValueChange(ValueChange& change)
+    {
+        return valueChanges.tryDequeue(change);
     }
 
     float getDefaultValue() const override
@@ -320,6 +335,65 @@ public:
     }
 
 private:
+    // Bounded multi-producer queue that never allocates, based on Dmitry Vyukov's bounded MPMC queue
+    // The host may set values from both the audio thread and the message thread
+    class ValueChangeQueue {
+    public:
+        static constexpr size_t capacity = 32;
+
+        ValueChangeQueue()
+        {
+            for (size_t i = 0; i < capacity; i++)
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        bool tryEnqueue(ValueChange const& change)
+        {
+            auto position = enqueuePosition.load(std::memory_order_relaxed);
+            while (true) {
+                auto& cell = cells[position & (capacity - 1)];
+                auto difference = static_cast<intptr_t>(cell.sequence.load(std::memory_order_acquire)) - static_cast<intptr_t>(position);
+                if (difference == 0) {
+                    if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        cell.change = change;
+                        cell.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (difference < 0) {
+                    return false;
+                } else {
+                    position = enqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool tryDequeue(ValueChange& change)
+        {
+            auto position = dequeuePosition.load(std::memory_order_relaxed);
+            auto& cell = cells[position & (capacity - 1)];
+            auto difference = static_cast<intptr_t>(cell.sequence.load(std::memory_order_acquire)) - static_cast<intptr_t>(position + 1);
+            if (difference < 0)
+                return false;
+
+            change = cell.change;
+            dequeuePosition.store(position + 1, std::memory_order_relaxed);
+            cell.sequence.store(position + capacity, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            ValueChange change;
+        };
+
+        Cell cells[capacity];
+        std::atomic<size_t> enqueuePosition = 0;
+        std::atomic<size_t> dequeuePosition = 0; // Single consumer, so this doesn't need a compare-exchange
+    };
+
+    ValueChangeQueue valueChanges;
+
     float lastValue = 0.0f;
     float const defaultValue;
 
@@ -120,6 +120,7 @@ private:
         { "browser_path", var(ProjectInfo::appDataDir.getFullPathName()) },
         { "theme", var("light") },
         { "oversampling", var(0) },
+        { "oversampling_quality", var(1) },
         { "limiter_threshold", var(1) },
         { "protected", var(1) },
         { "debug_connections", var(1) },
@@ -0,0 +1,140 @@
+/*
+ // Copyright (c) 2024 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include "Utility/Containers.h"
+
+// Uniform grid over canvas coordinates, so we can find the items in an area without visiting every item in the patch
+// Items are stored in every cell their bounds overlap. Queries are conservative: callers still need to check exact bounds
+template<typename T, int CellSize = 256>
+class SpatialIndex {
+public:
+    void update(T* item, Rectangle<int> bounds)
+    {
+        auto cells = getCellRange(bounds);
+
+        auto it = itemCells.find(item);
+        if (it != itemCells.end()) {
+            if (it->second == cells)
+                return;
+
+            removeFromCells(item, it->second);
+            it->second = cells;
+        } else {
+            itemCells[item] = cells;
+        }
+
+        for (int x = cells.getX(); x <= cells.getRight(); x++) {
+            for (int y = cells.getY(); y <= cells.getBottom(); y++) {
+                grid[getCellKey(x, y)].add({ item, cells });
+            }
+        }
+    }
+
+    void remove(T* item)
+    {
+        auto it = itemCells.find(item);
+        if (it == itemCells.end())
+            return;
+
+        removeFromCells(item, it->second);
+        itemCells.erase(it);
+    }
+
+    // Calls the callback once for every item that might intersect the area
+    template<typename Callback>
+    void forEachItemIn(Rectangle<int> area, Callback&& callback) const
+    {
+        auto cells = getCellRange(area);
+
+        auto visitCell = [&cells, &callback](int x, int y, SmallArray<Entry, 4> const& entries) {
+            for (auto& [item, itemCells] : entries) {
+                // Items that span multiple cells are only reported from the first cell where they overlap the query
+                if (x == jmax(cells.getX(), itemCells.getX()) && y == jmax(cells.getY(), itemCells.getY()))
+                    callback(item);
+            }
+        };
+
+        // For very large areas, like the whole canvas, it's cheaper to visit only the cells that are occupied
+        auto numQueryCells = static_cast<int64>(cells.getWidth() + 1) * static_cast<int64>(cells.getHeight() + 1);
+        if (numQueryCells > static_cast<int64>(grid.size())) {
+            for (auto& [key, entries] : grid) {
+                auto x = static_cast<int>(static_cast<uint32>(key >> 32));
+                auto y = static_cast<int>(static_cast<uint32>(key));
+                if (x >= cells.getX() && x <= cells.getRight() && y >= cells.getY() && y <= cells.getBottom())
+                    visitCell(x, y, entries);
+            }
+            return;
+        }
+
+        for (int x = cells.getX(); x <= cells.getRight(); x++) {
+            for (int y = cells.getY(); y <= cells.getBottom(); y++) {
+                auto it = grid.find(getCellKey(x, y));
+                if (it != grid.end())
+                    visitCell(x, y, it->second);
+            }
+        }
+    }
+
+    void clear()
+    {
+        grid.clear();
+        itemCells.clear();
+    }
+
+private:
+    struct Entry {
+        T* item;
+        Rectangle<int> cells;
+    };
+
+    // Rectangle of cell coordinates, where right and bottom are inclusive
+    static Rectangle<int> getCellRange(Rectangle<int> bounds)
+    {
+        auto x1 = floorDiv(bounds.getX());
+        auto y1 = floorDiv(bounds.getY());
+        auto x2 = floorDiv(bounds.getRight());
+        auto y2 = floorDiv(bounds.getBottom());
+        return { x1, y1, x2 - x1, y2 - y1 };
+    }
+
+    static int floorDiv(int value)
+    {
+        return value >= 0 ? value / CellSize : (value - CellSize + 1) / CellSize;
+    }
+
+    static uint64 getCellKey(int x, int y)
+    {
+        return (static_cast<uint64>(static_cast<uint32>(x)) << 32) | static_cast<uint32>(y);
+    }
+
+    void removeFromCells(T* item, Rectangle<int> cells)
+    {
+        for (int x = cells.getX(); x <= cells.getRight(); x++) {
+            for (int y = cells.getY(); y <= cells.getBottom(); y++) {
+                auto it = grid.find(getCellKey(x, y));
+                if (it == grid.end())
+                    continue;
+
+                auto& entries = it->second;
+                for (int i = 0; i < entries.size(); i++) {
+                    if (entries[i].item == item) {
+                        // Order within a cell doesn't matter, so swap with the last entry
+                        entries[i] = entries.back();
+                        entries.pop_back();
+                        break;
+                    }
+                }
+                if (entries.empty())
+                    grid.erase(it);
+            }
+        }
+    }
+
+    UnorderedMap<uint64, SmallArray<Entry, 4>> grid;
+    UnorderedMap<T*, Rectangle<int>> itemCells;
+};
@@ -0,0 +1,111 @@
+// Measures the cost of moving audio between the host buffer and Pd's buffers, without running any DSP
+// Compares the copies through intermediate buffers that we used to make with the direct copies into Pd's buffers
+class AudioCopyBenchmark : public PlugDataUnitTest
+{
+public:
+    AudioCopyBenchmark(PluginEditor* editor) : PlugDataUnitTest(editor, "Audio Copy Benchmark")
+    {
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int hostBlockSize = 512 * 8; // 512 samples at 8x oversampling
+    static constexpr int pdBlockSize = 64;
+    static constexpr int numIterations = 200;
+
+    void perform() override
+    {
+        for (auto numChannels : { 2, 8, 32, 64 }) {
+            beginTest(String(numChannels) + " channels");
+            benchmarkChannels(numChannels);
+        }
+
+        signalDone();
+    }
+
+    // Prints the CPU time per second of (oversampled) audio
+    template<typename Callback>
+    static void addResult(int numChannels, String const& name, Callback&& callback)
+    {
+        auto const blocksPerSecond = sampleRate * 8.0 / hostBlockSize;
+        printResult(name, { { "channels", numChannels }, { "ms_per_second", measure(numIterations, callback) * blocksPerSecond } });
+    }
+
+    void benchmarkChannels(int numChannels)
+    {
+        AudioBuffer<float> host(numChannels, hostBlockSize);
+        host.clear();
+
+        // Stand-ins for Pd's sound buffers and the intermediate buffers
+        HeapArray<t_sample> soundIn(numChannels * pdBlockSize, 0.0f);
+        HeapArray<t_sample> soundOut(numChannels * pdBlockSize, 0.0f);
+        HeapArray<t_sample> vectorIn(numChannels * pdBlockSize, 0.0f);
+        HeapArray<t_sample> vectorOut(numChannels * pdBlockSize, 0.0f);
+        AudioBuffer<float> bufferIn(numChannels, pdBlockSize);
+        AudioBuffer<float> bufferOut(numChannels, pdBlockSize);
+
+        AudioFifo<float> inputFifo(numChannels, hostBlockSize * 3);
+        AudioFifo<float> outputFifo(numChannels, hostBlockSize * 3);
+        outputFifo.writeSilence(pdBlockSize);
+
+        auto viaVectors = [&] {
+            for (int offset = 0; offset < hostBlockSize; offset += pdBlockSize) {
+                for (int ch = 0; ch < numChannels; ch++)
+                    pd::Instance::copySamples(vectorIn.data() + ch * pdBlockSize, host.getReadPointer(ch, offset), pdBlockSize);
+                pd::Instance::copySamples(soundIn.data(), vectorIn.data(), numChannels * pdBlockSize); // libpd_process_raw
+                pd::Instance::copySamples(vectorOut.data(), soundOut.data(), numChannels * pdBlockSize);
+                for (int ch = 0; ch < numChannels; ch++)
+                    pd::Instance::copySamples(host.getWritePointer(ch, offset), vectorOut.data() + ch * pdBlockSize, pdBlockSize);
+            }
+        };
+
+        auto direct = [&] {
+            for (int offset = 0; offset < hostBlockSize; offset += pdBlockSize) {
+                for (int ch = 0; ch < numChannels; ch++)
+                    pd::Instance::copySamples(soundIn.data() + ch * pdBlockSize, host.getReadPointer(ch, offset), pdBlockSize);
+                for (int ch = 0; ch < numChannels; ch++)
+                    pd::Instance::copySamples(host.getWritePointer(ch, offset), soundOut.data() + ch * pdBlockSize, pdBlockSize);
+            }
+        };
+
+        auto fifoViaBuffers = [&] {
+            auto block = dsp::AudioBlock<float>(host);
+            inputFifo.writeAudio(block);
+            while (inputFifo.getNumSamplesAvailable() >= pdBlockSize) {
+                inputFifo.readAudio(bufferIn);
+                for (int ch = 0; ch < numChannels; ch++)
+                    pd::Instance::copySamples(vectorIn.data() + ch * pdBlockSize, bufferIn.getReadPointer(ch), pdBlockSize);
+                pd::Instance::copySamples(soundIn.data(), vectorIn.data(), numChannels * pdBlockSize);
+                pd::Instance::copySamples(vectorOut.data(), soundOut.data(), numChannels * pdBlockSize);
+                for (int ch = 0; ch < numChannels; ch++)
+                    pd::Instance::copySamples(bufferOut.getWritePointer(ch), vectorOut.data() + ch * pdBlockSize, pdBlockSize);
+                outputFifo.writeAudio(bufferOut);
+            }
+            outputFifo.readAudio(block);
+        };
+
+        auto fifoDirect = [&] {
+            auto block = dsp::AudioBlock<float>(host);
+            inputFifo.writeAudio(block);
+            while (inputFifo.getNumSamplesAvailable() >= pdBlockSize) {
+                inputFifo.readRegions(pdBlockSize, [&](auto const& storage, int start, int offset, int size) {
+                    for (int ch = 0; ch < numChannels; ch++)
+                        pd::Instance::copySamples(soundIn.data() + ch * pdBlockSize + offset, storage.getReadPointer(ch, start), size);
+                });
+                outputFifo.writeRegions(pdBlockSize, [&](auto& storage, int start, int offset, int size) {
+                    for (int ch = 0; ch < numChannels; ch++)
+                        pd::Instance::copySamples(storage.getWritePointer(ch, start), soundOut.data() + ch * pdBlockSize + offset, size);
+                });
+            }
+            outputFifo.readAudio(block);
+        };
+
+        addResult(numChannels, "constant (via vectors)", viaVectors);
+        addResult(numChannels, "constant (direct)", direct);
+        addResult(numChannels, "variable (via buffers)", fifoViaBuffers);
+        addResult(numChannels, "variable (direct)", fifoDirect);
+
+        // Both variable paths should leave the fifos where they started
+        expectEquals(outputFifo.getNumSamplesAvailable(), pdBlockSize);
+    }
+};
@@ -0,0 +1,102 @@
+// Measures how much protected mode costs, and checks that the limiter keeps true peaks under its threshold
+class LimiterBenchmark : public PlugDataUnitTest
+{
+public:
+    LimiterBenchmark(PluginEditor* editor) : PlugDataUnitTest(editor, "Limiter Benchmark")
+    {
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+    static constexpr int numBlocks = 1000;
+    static constexpr float thresholddB = -6.0f;
+
+    void perform() override
+    {
+        for (auto numChannels : { 2, 16 }) {
+            beginTest(String(numChannels) + " channels");
+            benchmarkChannels<float>(numChannels);
+            benchmarkChannels<double>(numChannels);
+        }
+
+        signalDone();
+    }
+
+    // A loud sine close to a quarter of the sample rate, where the peaks between samples are much higher than the samples themselves
+    // Some invalid samples are mixed in, which protected mode should take out
+    template<typename SampleType>
+    static void fillBlock(AudioBuffer<SampleType>& buffer, int64 position)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ch++) {
+            auto* samples = buffer.getWritePointer(ch);
+            for (int i = 0; i < buffer.getNumSamples(); i++) {
+                auto const phase = static_cast<double>(position + i) * MathConstants<double>::twoPi * 11025.0 / sampleRate;
+                samples[i] = static_cast<SampleType>(2.0 * std::sin(phase + MathConstants<double>::pi / 4.0));
+            }
+            samples[ch % buffer.getNumSamples()] = std::numeric_limits<SampleType>::quiet_NaN();
+            samples[(ch + 7) % buffer.getNumSamples()] = std::numeric_limits<SampleType>::infinity();
+            samples[(ch + 13) % buffer.getNumSamples()] = std::numeric_limits<SampleType>::denorm_min();
+        }
+    }
+
+    // Reconstructs the signal between samples with a long windowed sinc, which is more precise than the limiter's own estimate
+    template<typename SampleType>
+    static double getTruePeak(AudioBuffer<SampleType> const& buffer, int channel)
+    {
+        constexpr int halfLength = 32;
+        constexpr int oversampleFactor = 8;
+        auto const* samples = buffer.getReadPointer(channel);
+
+        double peak = 0.0;
+        for (int i = halfLength; i < buffer.getNumSamples() - halfLength; i++) {
+            for (int phase = 0; phase < oversampleFactor; phase++) {
+                auto const fraction = static_cast<double>(phase) / oversampleFactor;
+                double value = 0.0;
+                for (int j = -halfLength + 1; j <= halfLength; j++) {
+                    auto const distance = fraction - j;
+                    auto const sinc = approximatelyEqual(distance, 0.0) ? 1.0 : std::sin(MathConstants<double>::pi * distance) / (MathConstants<double>::pi * distance);
+                    auto const window = 0.5 + 0.5 * std::cos(MathConstants<double>::pi * distance / (halfLength + 1));
+                    value += samples[i + j] * sinc * window;
+                }
+                peak = std::max(peak, std::abs(value));
+            }
+        }
+        return peak;
+    }
+
+    template<typename SampleType>
+    void benchmarkChannels(int numChannels)
+    {
+        Limiter<SampleType> limiter;
+        limiter.prepare({ sampleRate, static_cast<uint32>(blockSize), static_cast<uint32>(numChannels) });
+        limiter.setThreshold(thresholddB);
+
+        AudioBuffer<SampleType> buffer(numChannels, blockSize);
+        double elapsed = 0.0;
+        bool allFinite = true;
+
+        for (int i = 0; i < numBlocks; i++) {
+            fillBlock(buffer, static_cast<int64>(i) * blockSize);
+
+            elapsed += measure(1, [&limiter, &buffer] {
+                auto block = dsp::AudioBlock<SampleType>(buffer);
+                limiter.process(block);
+            });
+
+            for (int ch = 0; ch < numChannels; ch++) {
+                auto const range = FloatVectorOperations::findMinAndMax(buffer.getReadPointer(ch), blockSize);
+                allFinite = allFinite && std::isfinite(range.getStart()) && std::isfinite(range.getEnd());
+            }
+        }
+
+        auto const audioSeconds = static_cast<double>(numBlocks * blockSize) / sampleRate;
+        auto const truePeak = getTruePeak(buffer, 0);
+
+        printResult("Limiter", { { "channels", numChannels }, { "precision", std::is_same_v<SampleType, double> ? 64 : 32 }, { "ms_per_second", elapsed / audioSeconds }, { "true_peak_db", Decibels::gainToDecibels(truePeak) } });
+
+        expect(allFinite, "Invalid samples got through the limiter");
+        // The limiter estimates the true peak with a short interpolator, so allow a little overshoot
+        expectLessThan(Decibels::gainToDecibels(truePeak), static_cast<double>(thresholddB) + 0.2);
+    }
+};
@@ -0,0 +1,88 @@
+// Measures how much CPU time the audio callback takes for a DSP-heavy patch, for every precision this build supports
+// Run it in both a regular build and an ENABLE_DOUBLE_PRECISION build to compare 32-bit and 64-bit Pd
+class ProcessingBenchmark : public PlugDataUnitTest
+{
+public:
+    ProcessingBenchmark(PluginEditor* editor) : PlugDataUnitTest(editor, "Processing Benchmark")
+    {
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+    static constexpr int numBlocks = 1000;
+
+    void perform() override
+    {
+        auto* processor = editor->pd;
+        auto* cnv = editor->getTabComponent().openPatch(generatePatch(200));
+        expect(cnv != nullptr);
+
+        // Keep the audio device from calling into the processor while we use it
+        auto const wasDoublePrecision = processor->isUsingDoublePrecision();
+        auto const oldSampleRate = processor->getSampleRate();
+        auto const oldBlockSize = processor->AudioProcessor::getBlockSize();
+        processor->suspendProcessing(true);
+
+        beginTest("single precision");
+        benchmarkPrecision<float>(processor);
+
+        if (processor->supportsDoublePrecisionProcessing()) {
+            beginTest("double precision");
+            benchmarkPrecision<double>(processor);
+        }
+
+        processor->setProcessingPrecision(wasDoublePrecision ? AudioProcessor::doublePrecision : AudioProcessor::singlePrecision);
+        processor->prepareToPlay(oldSampleRate, oldBlockSize);
+        processor->suspendProcessing(false);
+
+        if (cnv)
+            editor->getTabComponent().closeTab(cnv);
+
+        signalDone();
+    }
+
+    // Parallel chains of oscillators and filters, where the feedback paths are sensitive to precision
+    static String generatePatch(int numChains)
+    {
+        MemoryOutputStream patch;
+        patch << "#N canvas 0 0 1000 700 12;\n";
+
+        for (int i = 0; i < numChains; i++) {
+            patch << "#X obj " << i * 10 << " 0 phasor~ " << 100 + i << ";\n";
+            patch << "#X obj " << i * 10 << " 40 lop~ " << 500 + i * 10 << ";\n";
+            patch << "#X obj " << i * 10 << " 80 *~ 0.001;\n";
+        }
+        patch << "#X obj 0 120 dac~;\n";
+
+        auto const dac = numChains * 3;
+        for (int i = 0; i < numChains; i++) {
+            patch << "#X connect " << i * 3 << " 0 " << i * 3 + 1 << " 0;\n";
+            patch << "#X connect " << i * 3 + 1 << " 0 " << i * 3 + 2 << " 0;\n";
+            patch << "#X connect " << i * 3 + 2 << " 0 " << dac << " " << i % 2 << ";\n";
+        }
+
+        return patch.toString();
+    }
+
+    template<typename SampleType>
+    void benchmarkPrecision(PluginProcessor* processor)
+    {
+        processor->setProcessingPrecision(std::is_same_v<SampleType, double> ? AudioProcessor::doublePrecision : AudioProcessor::singlePrecision);
+        processor->prepareToPlay(sampleRate, blockSize);
+
+        auto const numChannels = jmax(processor->getTotalNumInputChannels(), processor->getTotalNumOutputChannels());
+        AudioBuffer<SampleType> buffer(numChannels, blockSize);
+        MidiBuffer midi;
+
+        auto const msPerBlock = measure(numBlocks, [&] {
+            buffer.clear();
+            processor->processBlock(buffer, midi);
+        });
+
+        // CPU time spent per second of audio
+        printResult("processBlock", { { "pd_floatsize", PD_FLOATSIZE }, { "host_precision", std::is_same_v<SampleType, double> ? 64 : 32 }, { "ms_per_second", msPerBlock * sampleRate / blockSize } });
+
+        expect(std::isfinite(buffer.getSample(0, 0)));
+    }
+};
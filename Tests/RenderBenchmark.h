@@ -0,0 +1,95 @@
+// Measures how long synchronising and rendering takes for large synthetic patches
+// Results are written as JSON lines to stdout and to plugdata_render_benchmark.json in the temp directory,
+// so they can be compared between builds
+class RenderBenchmark : public PlugDataUnitTest
+{
+public:
+    RenderBenchmark(PluginEditor* editor) : PlugDataUnitTest(editor, "Render Benchmark")
+    {
+    }
+
+private:
+    static constexpr int numIterations = 20;
+
+    void perform() override
+    {
+        results = Array<var>();
+
+        for (auto numObjects : { 1000, 5000, 20000 }) {
+            beginTest(String(numObjects) + " objects");
+            benchmarkPatch(numObjects);
+        }
+
+        auto json = JSON::toString(var(results));
+        File::getSpecialLocation(File::tempDirectory).getChildFile("plugdata_render_benchmark.json").replaceWithText(json);
+
+        signalDone();
+    }
+
+    // Creates a grid of control objects, each connected to its right and bottom neighbour
+    static String generatePatch(int numObjects)
+    {
+        constexpr int columns = 100;
+        MemoryOutputStream patch;
+        patch << "#N canvas 0 0 1000 700 12;\n";
+
+        for (int i = 0; i < numObjects; i++) {
+            patch << "#X obj " << (i % columns) * 60 << " " << (i / columns) * 40 << " + " << (i % 7) << ";\n";
+        }
+        for (int i = 0; i < numObjects; i++) {
+            if ((i + 1) % columns != 0 && i + 1 < numObjects)
+                patch << "#X connect " << i << " 0 " << i + 1 << " 0;\n";
+            if (i + columns < numObjects)
+                patch << "#X connect " << i << " 0 " << i + columns << " 1;\n";
+        }
+
+        return patch.toString();
+    }
+
+    void addResult(int numObjects, String const& name, double milliseconds)
+    {
+        results.add(printResult(name, { { "objects", numObjects }, { "ms", milliseconds } }));
+    }
+
+    void benchmarkPatch(int numObjects)
+    {
+        Canvas* cnv = nullptr;
+        addResult(numObjects, "open", measure(1, [this, &cnv, numObjects] { cnv = editor->getTabComponent().openPatch(generatePatch(numObjects)); }));
+
+        expect(cnv != nullptr);
+        if (!cnv)
+            return;
+
+        // Synchronising an unchanged patch is what happens on most edits in large patches
+        addResult(numObjects, "performSynchronise", measure(numIterations, [cnv] { cnv->performSynchronise(); }));
+
+        auto& surface = editor->nvgSurface;
+        if (surface.makeContextActive()) {
+            auto* nvg = surface.getRawContext();
+            auto fullArea = cnv->getLocalBounds();
+            auto visibleArea = Rectangle<int>(cnv->canvasOrigin, cnv->canvasOrigin + Point<int>(1000, 700));
+
+            auto measureDrawing = [nvg](auto&& draw) {
+                return measure(numIterations, [nvg, &draw] {
+                    nvgBeginFrame(nvg, 1000, 700, 1.0f);
+                    draw();
+                    nvgCancelFrame(nvg);
+                });
+            };
+
+            addResult(numObjects, "renderAllObjects", measureDrawing([cnv, nvg, fullArea] { cnv->renderAllObjects(nvg, fullArea); }));
+            addResult(numObjects, "renderAllObjects (visible)", measureDrawing([cnv, nvg, visibleArea] { cnv->renderAllObjects(nvg, visibleArea); }));
+            addResult(numObjects, "renderAllConnections", measureDrawing([cnv, nvg, fullArea] { cnv->renderAllConnections(nvg, fullArea); }));
+            addResult(numObjects, "renderAllConnections (visible)", measureDrawing([cnv, nvg, visibleArea] { cnv->renderAllConnections(nvg, visibleArea); }));
+
+            addResult(numObjects, "NVGSurface::render", measure(numIterations, [&surface] {
+                surface.invalidateAll();
+                surface.render();
+            }));
+        }
+
+        editor->getTabComponent().closeTab(cnv);
+    }
+
+    Array<var> results;
+};
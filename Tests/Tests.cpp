@@ -1,6 +1,11 @@
 #include "Tests.h"
 #include "ObjectFuzzTest.h"
 #include "HelpfileFuzzTest.h"
+#include "RenderBenchmark.h"
+#include "WeakReferenceBenchmark.h"
+#include "ProcessingBenchmark.h"
+#include "AudioCopyBenchmark.h"
+#include "LimiterBenchmark.h"
 
 void runTests(PluginEditor* editor)
 {
@@ -11,9 +16,15 @@ void runTests(PluginEditor* editor)
     std::thread testRunnerThread([editor] {
         ObjectFuzzTest objectFuzzer(editor);
         HelpFileFuzzTest helpfileFuzzer(editor);
+        RenderBenchmark renderBenchmark(editor);
+        WeakReferenceBenchmark weakReferenceBenchmark(editor);
+        ProcessingBenchmark processingBenchmark(editor);
+        AudioCopyBenchmark audioCopyBenchmark(editor);
+        LimiterBenchmark limiterBenchmark(editor);
         
         UnitTestRunner runner;
         //runner.runTests({&objectFuzzer, &helpfileFuzzer}, 1);
+        runner.runTests({&renderBenchmark, &weakReferenceBenchmark, &processingBenchmark, &audioCopyBenchmark, &limiterBenchmark}, 1);
     });
     testRunnerThread.detach();
 }
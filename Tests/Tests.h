@@ -1,5 +1,6 @@
 #include <juce_gui_basics/juce_gui_basics.h>
 #include <random>
+#include <iostream>
 
 #include "Utility/Config.h"
 #include "Utility/OSUtils.h"
@@ -75,6 +76,32 @@ protected:
         }
     }
 
+    // Runs the callback a number of times, and returns the average time of one run in milliseconds
+    template<typename Callback>
+    static double measure(int numIterations, Callback&& callback)
+    {
+        auto start = Time::getHighResolutionTicks();
+        for (int i = 0; i < numIterations; i++)
+        {
+            callback();
+        }
+        auto elapsed = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start);
+        return elapsed * 1000.0 / numIterations;
+    }
+
+    // Prints a benchmark result as a JSON line to stdout, so it can be compared between builds
+    static var printResult(String const& name, NamedValueSet const& properties)
+    {
+        auto* result = new DynamicObject();
+        result->setProperty("benchmark", name);
+        for (auto const& property : properties)
+            result->setProperty(property.name, property.value);
+
+        auto resultVar = var(result);
+        std::cout << JSON::toString(resultVar, true) << std::endl;
+        return resultVar;
+    }
+
 private:
 
     void runTest() final
@@ -0,0 +1,93 @@
+// Measures the cost of creating and destroying pd::WeakReferences, which happens for every object on tab switches and reloads
+// Also measures how that is affected by another thread invalidating references at the same time, like the audio thread does when Pd frees objects
+class WeakReferenceBenchmark : public PlugDataUnitTest
+{
+public:
+    WeakReferenceBenchmark(PluginEditor* editor) : PlugDataUnitTest(editor, "Weak Reference Benchmark")
+    {
+    }
+
+private:
+    static constexpr int numIterations = 20;
+    static constexpr int referencesPerObject = 4;
+
+    void perform() override
+    {
+        for (auto numObjects : { 1000, 10000, 100000 }) {
+            beginTest(String(numObjects) + " objects");
+            benchmarkReferences(numObjects);
+        }
+
+        signalDone();
+    }
+
+    static void addResult(int numObjects, String const& name, double milliseconds)
+    {
+        printResult(name, { { "objects", numObjects }, { "ms", milliseconds } });
+    }
+
+    void benchmarkReferences(int numObjects)
+    {
+        auto* instance = editor->pd;
+
+        // The registry only looks at the addresses, so these don't need to be real Pd objects
+        HeapArray<int64> fakeObjects(numObjects, 0);
+        HeapArray<int> destructionOrder(numObjects * referencesPerObject, 0);
+        for (int i = 0; i < destructionOrder.size(); i++) {
+            destructionOrder[i] = i;
+        }
+        std::shuffle(destructionOrder.begin(), destructionOrder.end(), std::mt19937(1234));
+
+        auto createReferences = [&fakeObjects, instance](auto& references) {
+            for (auto& object : fakeObjects) {
+                for (int i = 0; i < referencesPerObject; i++) {
+                    references.emplace_back(std::make_unique<pd::WeakReference>(&object, instance));
+                }
+            }
+        };
+
+        auto createAndDestroy = [&](bool randomOrder) {
+            std::vector<std::unique_ptr<pd::WeakReference>> references;
+            references.reserve(destructionOrder.size());
+            createReferences(references);
+
+            if (randomOrder) {
+                for (auto index : destructionOrder) {
+                    references[index].reset();
+                }
+            }
+        };
+
+        addResult(numObjects, "create + destroy", measure(numIterations, [&] { createAndDestroy(false); }));
+        addResult(numObjects, "create + destroy (random order)", measure(numIterations, [&] { createAndDestroy(true); }));
+
+        // Invalidate references to unrelated objects from another thread, to see how much the registry contends
+        std::atomic<bool> stopClearing = false;
+        HeapArray<int64> clearedObjects(1024, 0);
+        std::thread clearThread([&stopClearing, &clearedObjects, instance] {
+            while (!stopClearing.load()) {
+                for (auto& object : clearedObjects) {
+                    instance->clearWeakReferences(&object);
+                }
+            }
+        });
+
+        addResult(numObjects, "create + destroy (concurrent clear)", measure(numIterations, [&] { createAndDestroy(true); }));
+
+        stopClearing = true;
+        clearThread.join();
+
+        // Check that invalidation reaches every reference to an object
+        std::vector<std::unique_ptr<pd::WeakReference>> references;
+        createReferences(references);
+        for (auto& object : fakeObjects) {
+            instance->clearWeakReferences(&object);
+        }
+
+        bool allCleared = true;
+        for (auto& reference : references) {
+            allCleared = allCleared && !reference->isValid();
+        }
+        expect(allCleared);
+    }
+};